@@ -0,0 +1,95 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define valloc malloc
+
+#define ALIGN_TO 16
+
+/*
+ * Grow-only bump allocator. Allocations live until the next arena_reset(),
+ * which folds all blocks needed so far into a single one of the high water
+ * size, so once the largest input was seen no further allocations happen.
+ */
+struct arena_block {
+    struct arena_block *prev;
+    size_t size;
+    size_t used;
+
+    uint8_t data[] __attribute__ ((aligned (ALIGN_TO)));
+};
+
+struct arena {
+    struct arena_block *block;
+
+    size_t used;
+    size_t high_water;
+};
+
+static inline struct arena_block *
+arena_block_new(struct arena_block *prev, size_t size)
+{
+    struct arena_block *block = valloc(sizeof(struct arena_block) + size);
+
+    block->prev = prev;
+    block->size = size;
+    block->used = 0;
+
+    return block;
+}
+
+static inline void
+arena_release(struct arena *arena)
+{
+    while (arena->block != NULL) {
+        struct arena_block *prev = arena->block->prev;
+        free(arena->block);
+        arena->block = prev;
+    }
+
+    arena->used = 0;
+}
+
+static inline void
+arena_reset(struct arena *arena)
+{
+    if (arena->block != NULL && arena->block->prev != NULL) {
+        arena_release(arena);
+        arena->block = arena_block_new(NULL, arena->high_water);
+    }
+
+    if (arena->block != NULL) {
+        arena->block->used = 0;
+    }
+
+    arena->used = 0;
+}
+
+static inline void *
+arena_alloc(struct arena *arena, size_t size)
+{
+    size = (size + ALIGN_TO - 1) & ~((size_t) ALIGN_TO - 1);
+
+    struct arena_block *block = arena->block;
+
+    if (block == NULL || block->size - block->used < size) {
+        size_t block_size = block == NULL ? 4096 : 2 * block->size;
+        block_size = block_size > size ? block_size : size;
+        block = arena->block = arena_block_new(block, block_size);
+    }
+
+    void *ptr = &block->data[block->used];
+    block->used += size;
+
+    arena->used += size;
+    if (arena->used > arena->high_water) {
+        arena->high_water = arena->used;
+    }
+
+    return ptr;
+}
+
+#endif /* ARENA_H */
@@ -0,0 +1,165 @@
+"""
+Benchmark for the tournament solver.
+
+Generates tournaments over a grid of player counts, budgets and bribe
+distributions, runs every solver mode on them and prints one JSON record
+per (workload, mode) with latency percentiles, solves per case and
+augmentations per second. Answers are cross-checked between modes and,
+when OR-tools is installed, against concept3.py on the small workloads.
+
+    python3 bench.py --binary ./project1-bench > bench.json
+"""
+import argparse
+import itertools
+import json
+import random
+import subprocess
+import sys
+
+
+ENGINES = ["spfa", "dijkstra", "scaling", "primal-dual"]
+SEARCHES = ["linear", "binary"]
+
+
+def bribe_sampler(distribution, rng):
+    if distribution == "uniform":
+        return lambda: rng.randint(1, 15)
+    if distribution == "skewed":
+        return lambda: min(1000, int(rng.expovariate(1 / 4)) + 1)
+    if distribution == "constant":
+        return lambda: 5
+    raise ValueError(distribution)
+
+
+def generate(player_count, budget_level, distribution, cases, rng):
+    """ returns [(budget, player_count, games)] """
+    bribe = bribe_sampler(distribution, rng)
+    tournaments = []
+
+    for _ in range(cases):
+        games = []
+        for i in range(player_count):
+            for j in range(i + 1, player_count):
+                games.append((i, j, rng.choice((i, j)), bribe()))
+
+        # budget in units of "bribes per player"
+        budget = int(budget_level * player_count * 5)
+        tournaments.append((budget, player_count, games))
+
+    return tournaments
+
+
+def format_input(tournaments):
+    lines = [str(len(tournaments))]
+    for budget, player_count, games in tournaments:
+        lines.append(str(budget))
+        lines.append(str(player_count))
+        lines.extend(f"{a} {b} {w} {c}" for a, b, w, c in games)
+
+    return "\n".join(lines) + "\n"
+
+
+def run(binary, data, engine, search, warm):
+    args = [binary, "--stats=json", "-e", engine, "-s", search]
+    if warm:
+        args.append("-w")
+
+    proc = subprocess.run(args, input=data, capture_output=True, text=True,
+                          check=True)
+
+    answers = proc.stdout.split()
+    cases = []
+    for line in proc.stderr.splitlines():
+        stats = json.loads(line)
+        cases.append((stats["limits"], stats["augmentations"],
+                      stats["total_usec"]))
+
+    return answers, cases
+
+
+def percentile(values, q):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(q * len(values)))]
+
+
+def reference_answers(tournaments):
+    try:
+        from concept3 import tournament
+    except ImportError:
+        return None
+
+    return ["TAK" if tournament(player_count, budget, games, draw=False)
+            else "NIE" for budget, player_count, games in tournaments]
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--binary", default="./project1")
+    parser.add_argument("--players", default="10,50,100,200")
+    parser.add_argument("--budgets", default="0.1,0.5,2")
+    parser.add_argument("--distributions", default="uniform,skewed,constant")
+    parser.add_argument("--cases", type=int, default=5)
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--reference-limit", type=int, default=30,
+                        help="largest player count checked against OR-tools")
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    modes = list(itertools.product(ENGINES, SEARCHES, (False, True)))
+    failed = False
+
+    for player_count, budget_level, distribution in itertools.product(
+            [int(p) for p in args.players.split(",")],
+            [float(b) for b in args.budgets.split(",")],
+            args.distributions.split(",")):
+
+        tournaments = generate(player_count, budget_level, distribution,
+                               args.cases, rng)
+        data = format_input(tournaments)
+
+        reference = None
+        if player_count <= args.reference_limit:
+            reference = reference_answers(tournaments)
+
+        expected = reference
+        for engine, search, warm in modes:
+            answers, cases = run(args.binary, data, engine, search, warm)
+
+            if expected is None:
+                expected = answers
+            mismatches = sum(a != b for a, b in zip(answers, expected))
+            failed = failed or mismatches > 0
+
+            usecs = [usec for _, _, usec in cases]
+            augmentations = sum(aug for _, aug, _ in cases)
+
+            print(json.dumps({
+                "players": player_count,
+                "budget_level": budget_level,
+                "distribution": distribution,
+                "engine": engine,
+                "search": search,
+                "warm_start": warm,
+                "cases": len(cases),
+                "latency_usec": {
+                    "p50": percentile(usecs, 0.50),
+                    "p90": percentile(usecs, 0.90),
+                    "p99": percentile(usecs, 0.99),
+                    "max": max(usecs),
+                    "mean": sum(usecs) / len(usecs),
+                },
+                "solves_per_case": sum(s for s, _, _ in cases) / len(cases),
+                "augmentations_per_sec":
+                    augmentations / max(sum(usecs), 1) * 1e6,
+                "checked_against": "ortools" if reference else "modes",
+                "mismatches": mismatches,
+            }))
+            sys.stdout.flush()
+
+    if failed:
+        print("answers differ between solver modes", file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
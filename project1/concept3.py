@@ -1,11 +1,9 @@
 import math
 # from ortools.linear_solver import pywraplp
 from ortools.graph.pywrapgraph import SimpleMinCostFlow
-import pydot
-import imgcat
 
 
-def tournament(player_count, budget, games_data):
+def tournament(player_count, budget, games_data, draw=True):
 
     def cycle(x):
         solver = SimpleMinCostFlow()
@@ -55,8 +53,12 @@ def tournament(player_count, budget, games_data):
             return False
 
 
-        dot = pydot.Dot(rankdir="LR")
-#        dot = None
+        if draw:
+            import pydot
+            import imgcat
+            dot = pydot.Dot(rankdir="LR")
+        else:
+            dot = None
 
         if dot:
             for i, v in enumerate(indices):
@@ -80,13 +82,15 @@ def tournament(player_count, budget, games_data):
             elif not game_count > 200:
                 dot.write_png(f"{player_count}_big_boy.png")
 
-        print("cost = ", solver.OptimalCost())
+        if draw:
+            print("cost = ", solver.OptimalCost())
 
         return True
 
     for x in range(0, player_count):
         if cycle(x):
-            print(x)
+            if draw:
+                print(x)
             return True
 
     return False
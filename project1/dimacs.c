@@ -0,0 +1,277 @@
+/*
+ * Min-cost flow over DIMACS files, the engine of mcf.h outside of any
+ * tournament:
+ *
+ *     c comment
+ *     p min <nodes> <arcs>
+ *     n <id> <supply>                      (demand when negative)
+ *     a <tail> <head> <low> <cap> <cost>
+ *
+ * Supplies and demands hang off a super source and a super sink. Lower bounds
+ * are sent up front and arcs of negative cost saturated up front, the network
+ * carries their reversal instead, so it starts without negative cycles.
+ */
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <getopt.h>
+
+#define MCF_VERTEX_T int32_t
+#define MCF_UNIT_T int64_t
+#define MCF_COST_T int64_t
+
+#include "mcf.h"
+
+/* an arc of the file, edge `i` of the network is arc `i` or its reversal */
+struct arc {
+    vertex_t tail;
+    vertex_t head;
+
+    unit_t sent; /* before solving, its lower bound or all of a negative arc */
+    bool reversed;
+};
+
+struct problem {
+    vertex_t node_count;
+    edge_t arc_count;
+
+    struct arc *arcs;
+    cost_t sent_cost;
+
+    unit_t *supply;
+    unit_t total_supply;
+    unit_t total_demand;
+
+    /* as the n lines have it, before lower bounds and negative arcs shift it */
+    unit_t *file_supply;
+    unit_t total_file_supply;
+
+    struct network network;
+};
+
+static void
+fail(int line, const char *message)
+{
+    fprintf(stderr, "line %d: %s\n", line, message);
+    exit(1);
+}
+
+static void
+read_problem(FILE *input, struct problem *problem, struct arena *arena)
+{
+    struct network *network = &problem->network;
+    char *text = NULL;
+    size_t text_size = 0;
+    int line = 0;
+    edge_t cursor = 0;
+    bool header = false;
+
+    while (getline(&text, &text_size, input) != -1) {
+        long long tail, head, low, capacity, cost;
+        int fields;
+
+        line++;
+
+        /* indented and blank lines are in the wild */
+        const char *buffer = text + strspn(text, " \t\r\v\f");
+
+        switch (buffer[0]) {
+        case 'p':
+            if (header) {
+                fail(line, "second problem line");
+            }
+
+            if (sscanf(buffer, "p min %lld %lld", &tail, &head) != 2
+                    || tail <= 0 || head < 0 || tail >= INT32_MAX - 2
+                    || head > INT32_MAX - tail) {
+                fail(line, "expected p min <nodes> <arcs>");
+            }
+
+            problem->node_count = tail;
+            problem->arc_count = head;
+
+            /* 0 is the super source, nodes keep their ids, then the super sink */
+            network_init(network, arena, problem->node_count + 2,
+                         problem->arc_count + problem->node_count, 0, 0);
+
+            network->source = 0;
+            network->sink = problem->node_count + 1;
+
+            problem->arcs = arena_alloc(arena, sizeof(struct arc) * problem->arc_count);
+            problem->supply = arena_alloc(arena,
+                    sizeof(unit_t) * (problem->node_count + 1));
+            memset(problem->supply, 0, sizeof(unit_t) * (problem->node_count + 1));
+            problem->file_supply = arena_alloc(arena,
+                    sizeof(unit_t) * (problem->node_count + 1));
+            memset(problem->file_supply, 0, sizeof(unit_t) * (problem->node_count + 1));
+
+            header = true;
+            break;
+
+        case 'n':
+            fields = sscanf(buffer, "n %lld %lld", &tail, &capacity);
+
+            if (!header || fields != 2 || tail < 1 || tail > problem->node_count) {
+                fail(line, "expected n <id> <supply> after the problem line");
+            }
+
+            problem->supply[tail] += capacity;
+            problem->file_supply[tail] += capacity;
+            break;
+
+        case 'a':
+            fields = sscanf(buffer, "a %lld %lld %lld %lld %lld",
+                            &tail, &head, &low, &capacity, &cost);
+
+            if (!header || fields != 5 || cursor == problem->arc_count
+                    || tail < 1 || tail > problem->node_count
+                    || head < 1 || head > problem->node_count
+                    || low < 0 || capacity < low) {
+                fail(line, "expected a <tail> <head> <low> <cap> <cost>");
+            }
+
+            struct arc *arc = &problem->arcs[cursor];
+
+            arc->tail = tail;
+            arc->head = head;
+            arc->sent = cost < 0 ? capacity : low;
+            arc->reversed = cost < 0;
+
+            problem->sent_cost += (cost_t) arc->sent * cost;
+            problem->supply[tail] -= arc->sent;
+            problem->supply[head] += arc->sent;
+
+            if (arc->reversed) {
+                add_edge(network, &cursor, head, tail, capacity - low, -cost);
+            } else {
+                add_edge(network, &cursor, tail, head, capacity - low, cost);
+            }
+            break;
+
+        case 'c':
+        case '\n':
+        case '\0':
+            break;
+
+        default:
+            fail(line, "unknown line");
+        }
+    }
+
+    free(text);
+
+    if (!header || cursor != problem->arc_count) {
+        fail(line, "fewer arcs than announced");
+    }
+
+    for (vertex_t v = 1; v <= problem->node_count; v++) {
+        problem->total_file_supply += max(problem->file_supply[v], 0);
+
+        if (problem->supply[v] > 0) {
+            add_edge(network, &cursor, network->source, v, problem->supply[v], 0);
+            problem->total_supply += problem->supply[v];
+        } else if (problem->supply[v] < 0) {
+            add_edge(network, &cursor, v, network->sink, -problem->supply[v], 0);
+            problem->total_demand -= problem->supply[v];
+        }
+    }
+
+    network->edge_count = cursor;
+}
+
+/* flow on arc `arc` of the file */
+static unit_t
+arc_flow(const struct problem *problem, edge_t arc)
+{
+    unit_t flow = edge_flow(&problem->network, arc);
+
+    if (problem->arcs[arc].reversed) {
+        return problem->arcs[arc].sent - flow;
+    }
+
+    return problem->arcs[arc].sent + flow;
+}
+
+static void
+usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [-e spfa|dijkstra|scaling|primal-dual] [-f]"
+            " < problem.min\n", argv0);
+    exit(2);
+}
+
+int
+main(int argc, char *argv[])
+{
+    enum engine engine = ENGINE_DIJKSTRA;
+    bool flows = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "e:f")) != -1) {
+        switch (opt) {
+        case 'e':
+            if (!engine_by_name(optarg, &engine)) {
+                usage(argv[0]);
+            }
+            break;
+
+        case 'f':
+            flows = true;
+            break;
+
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    struct arena arena = { 0 };
+    struct problem problem = { 0 };
+    struct network *network = &problem.network;
+
+    int64_t started = now_usec();
+
+    read_problem(stdin, &problem, &arena);
+    network_layout(network);
+
+    int64_t read = now_usec();
+
+    network->engine = engine;
+    network->total_cost = 0;
+    network->total_flow = 0;
+
+    maxflow(network);
+
+    int64_t solved = now_usec();
+    cost_t cost = problem.sent_cost + network->total_cost;
+
+    printf("c nodes = %d, arcs = %d\n", problem.node_count, problem.arc_count);
+    /* what the shifts added to the supply is not the file's flow */
+    printf("c flow = %lld of %lld\n",
+           (long long) (network->total_flow
+                        - (problem.total_supply - problem.total_file_supply)),
+           (long long) problem.total_file_supply);
+    printf("c usec = %lld, read = %lld, solve = %lld\n",
+           (long long) (solved - started), (long long) (read - started),
+           (long long) (solved - read));
+
+    if (network->total_flow != problem.total_supply
+            || problem.total_supply != problem.total_demand) {
+        printf("s infeasible\n");
+        arena_release(&arena);
+        return 1;
+    }
+
+    printf("s %lld\n", (long long) cost);
+
+    if (flows) {
+        for (edge_t arc = 0; arc < problem.arc_count; arc++) {
+            printf("f %d %d %lld\n", problem.arcs[arc].tail, problem.arcs[arc].head,
+                   (long long) arc_flow(&problem, arc));
+        }
+    }
+
+    arena_release(&arena);
+    return 0;
+}
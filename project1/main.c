@@ -3,490 +3,572 @@
 #include <stdlib.h>
 #include <limits.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <time.h>
 
-#if 1
-#undef DDEEBBUUGG
-#endif
-#define valloc malloc
+#include "solver.h"
 
-#ifdef DDEEBBUUGG 
+#ifdef DDEEBBUUGG
 FILE *dot_file;
-#define dotdebug(...) fprintf(dot_file, __VA_ARGS__)
-#define dprintf(...) printf(__VA_ARGS__)
-#else
-#define dotdebug(...)
-#define dprintf(...) 
 #endif
 
+static void
+print_stats_header(enum stats stats)
+{
+    if (stats != STATS_CSV) {
+        return;
+    }
 
-#define min(a, b) ((a) < (b) ? (a) : (b))
-#define max(a, b) ((a) > (b) ? (a) : (b))
-
-typedef int32_t vertex_t;
-typedef int32_t player_idx_t;
-typedef int32_t unit_t;
-
-#define UNIT_MIN 0x80000000
-#define UNIT_MAX 0x7fffffff
-#define ALIGN_TO 16
-
-struct edge {
-    vertex_t tail; /* from */
-    vertex_t head; /* to */
-
-    unit_t flow;
-    unit_t capacity;
-    unit_t cost;
+    fprintf(stderr, "case,players,answer,total_usec,read_usec");
+#define X(name) fprintf(stderr, "," #name);
+    COUNTERS(X)
+#undef X
+    fprintf(stderr, "\n");
+}
 
-    struct edge *next_head;
-    struct edge *next_tail;
+/* one line per case on stderr, a single write so threads do not interleave */
+void
+print_stats(enum stats stats, const struct tournament_input *input,
+            const struct counters *counters, int64_t total_usec, bool found)
+{
+    char line[1024];
+    int len;
+
+    if (stats == STATS_JSON) {
+        len = snprintf(line, sizeof(line), 
+                       "{\"case\": %d, \"players\": %d, \"answer\": \"%s\", "
+                       "\"total_usec\": %lld, \"read_usec\": %lld", 
+                       input->index, input->player_count, found ? "TAK" : "NIE",
+                       (long long) total_usec, (long long) input->read_usec);
+#define X(name) \
+        len += snprintf(line + len, sizeof(line) - len, ", \"" #name "\": %lld", \
+                        (long long) counters->name);
+        COUNTERS(X)
+#undef X
+        len += snprintf(line + len, sizeof(line) - len, "}\n");
+    } else {
+        len = snprintf(line, sizeof(line), "%d,%d,%s,%lld,%lld", 
+                       input->index, input->player_count, found ? "TAK" : "NIE",
+                       (long long) total_usec, (long long) input->read_usec);
+#define X(name) \
+        len += snprintf(line + len, sizeof(line) - len, ",%lld", \
+                        (long long) counters->name);
+        COUNTERS(X)
+#undef X
+        len += snprintf(line + len, sizeof(line) - len, "\n");
+    }
 
-} __attribute__ ((aligned (ALIGN_TO)));
+    fputs(line, stderr);
+}
 
-struct vertex {
-    unit_t avail;
-    unit_t dist;
-    struct edge *parent;
+/*
+ * Reads one case. False when it is malformed, the scanner's error says why:
+ * a count or a game missing, or a game naming a player out of range or a
+ * winner not playing in it. The games are checked to fit in what is left of
+ * the input before any room is made for them.
+ */
+bool
+read_tournament(struct scanner *scanner, struct tournament_input *input,
+                struct arena *arena)
+{
+    const int64_t started = now_usec();
+    player_idx_t player_a, player_b, winner;
+    int32_t bribe;
 
-    struct edge *adj_head;
-    struct edge *adj_tail;
+    input->player_count = 0;
+    input->games = NULL;
 
-} __attribute__ ((aligned (ALIGN_TO)));
+    int32_t budget, player_count;
 
-struct vertex_queue {
-    vertex_t cursor;
-    vertex_t end;
+    if (!scanner_int32(scanner, &budget) || !scanner_int32(scanner, &player_count)) {
+        return false;
+    }
 
-    /* TODO uint64_t *in_queue;  */ 
-    bool *in_queue;
-    vertex_t *queue;
+    if (player_count < 0 || player_count > MAX_PLAYERS) {
+        return scanner_fail(scanner, "player count out of range");
+    }
 
-} __attribute__ ((aligned (ALIGN_TO)));
+    int32_t game_count = ((player_count * (player_count - 1)) / 2);
 
+    if ((int64_t) game_count * MIN_GAME_BYTES > (int64_t) scanner_left(scanner)) {
+        return scanner_fail(scanner, "fewer games than the players play");
+    }
 
-struct network {
-    vertex_t vertex_count; 
-    vertex_t edge_count;
+    struct game *games = arena_alloc(arena, sizeof(struct game) * game_count);
 
-    unit_t total_cost;
-    unit_t total_flow;
+    for (int32_t game_idx = 0; game_idx < game_count; game_idx++) {
+        struct game *game = &games[game_idx];
 
-    vertex_t source; 
-    vertex_t sink; 
+        if (!scanner_int32(scanner, &player_a) || !scanner_int32(scanner, &player_b)
+                || !scanner_int32(scanner, &winner)
+                || !scanner_int32(scanner, &bribe)) {
+            return false;
+        }
 
-    struct edge *edges;
+        if (player_a < 0 || player_a >= player_count
+                || player_b < 0 || player_b >= player_count) {
+            return scanner_fail(scanner, "player out of range");
+        }
 
-    struct edge **source_player;
-    struct edge **player_limit;
+        if (player_a == player_b) {
+            return scanner_fail(scanner, "player playing itself");
+        }
 
-    struct edge *limit_sink;
+        if (winner != player_a && winner != player_b) {
+            return scanner_fail(scanner, "winner not playing");
+        }
 
-    struct vertex *vertices;
+        game->winner = winner;
+        game->loser = winner == player_a ? player_b : player_a;
+        game->bribe = bribe;
+    }
 
-    struct vertex_queue queue;
+    input->budget = budget;
+    input->player_count = player_count;
+    input->games = games;
+    input->read_usec = now_usec() - started;
 
-} __attribute__ ((aligned (ALIGN_TO)));
+    return true;
+}
 
-static inline void
-vertex_queue_put(struct network *network, vertex_t vertex)
+/*
+ * Whether the narrow engine holds the case: 16 bits for every vertex and
+ * capacity, and distances, potentials and reduced costs, all sums of a few
+ * paths' worth of kept bribes, well inside 32 bits.
+ */
+static bool
+fits_narrow(const struct tournament_input *input)
 {
-    struct vertex_queue *queue = &network->queue;
-    
-    if (queue->in_queue[vertex]) {
-        return;
-    }
+    const int64_t player_count = input->player_count;
+    const int64_t game_count = player_count * (player_count - 1) / 2;
+    int64_t bribe_total = 0;
 
-    if (queue->cursor == -1) {
-        queue->cursor = 0;
-        queue->end = 0;
-        queue->queue[0] = vertex;
-    } else {
-        queue->end = (queue->end + 1) % network->vertex_count;
-        queue->queue[queue->end] = vertex;
+    if (game_count > INT16_MAX) {
+        return false;
     }
 
-    queue->in_queue[vertex] = true;
-}
+    for (int64_t game_idx = 0; game_idx < game_count; game_idx++) {
+        int64_t bribe = input->games[game_idx].bribe;
 
-static inline bool
-vertex_queue_empty(struct network *network)
-{
-    struct vertex_queue *queue = &network->queue;
-    return queue->cursor == -1;
+        if (bribe <= input->budget) {
+            bribe_total += bribe < 0 ? -bribe : bribe;
+        }
+    }
+
+    return bribe_total <= INT32_MAX / 8;
 }
 
-static inline vertex_t
-vertex_queue_pop(struct network *network) 
+bool
+solve_tournament(struct solver *solver, const struct tournament_input *input)
 {
-    struct vertex_queue *queue = &network->queue;
+    enum width width = solver->options->width;
 
-    vertex_t vertex = queue->queue[queue->cursor];
-    if (queue->cursor == queue->end) {
-        queue->cursor = -1;
-    } else {
-        queue->cursor = (queue->cursor + 1) % network->vertex_count;
+    if (width != WIDTH_WIDE && fits_narrow(input)) {
+        return solve_tournament_narrow(solver, input);
     }
 
-    queue->in_queue[vertex] = false;
-    return vertex;
+    return solve_tournament_wide(solver, input);
 }
 
-static inline void 
-relax(struct network *network, struct edge *edge)
-{
-    struct vertex *head = &network->vertices[edge->head];
-    struct vertex *tail = &network->vertices[edge->tail];
+/*
+ * Work stealing over case indices. Every worker owns a range [begin, end)
+ * packed into one atomic word, takes cases from its front and once it runs
+ * dry steals the back half of another worker's range.
+ */
+struct worker {
+    _Atomic uint64_t range;
 
-    unit_t dist = tail->dist;
-    unit_t d;
-    unit_t avail;
+    int id;
+    pthread_t thread;
+    struct pool *pool;
 
+    struct solver solver;
 
-    if (dist != UNIT_MAX) {
-        d = dist + edge->cost;
-        avail = edge->capacity - edge->flow;
+} __attribute__ ((aligned (64)));
 
-        if (head->dist > d && avail > 0) {
-            head->dist = d;
-            head->parent = edge;
-            head->avail = min(avail, tail->avail);
+struct pool {
+    const struct options *options;
 
-            vertex_queue_put(network, edge->head);
-        }
-    }
+    int case_count;
+    struct tournament_input *inputs;
+    struct arena input_arena;
+    bool *answers;
 
-    dist = head->dist;
-    if (dist != UNIT_MAX) {
-        d = dist - edge->cost;
-        avail = edge->flow;
+    int worker_count;
+    struct worker *workers;
+};
 
-        if (tail->dist > d && avail > 0) {
-            tail->dist = d;
-            tail->parent = edge;
-            tail->avail = min(avail, head->avail);
+#define RANGE(begin, end) \
+    ((((uint64_t) (begin)) << 32) | ((uint64_t) (uint32_t) (end)))
 
-            vertex_queue_put(network, edge->tail);
-        }
-    }
-}
+#define RANGE_BEGIN(range) ((uint32_t) ((range) >> 32))
+#define RANGE_END(range) ((uint32_t) (range))
 
-static void
-bellman_ford(struct network *network)
+static bool
+worker_take(struct worker *worker, uint32_t *index)
 {
-    for (vertex_t v = 0; v < network->vertex_count; v++) {
-        /* network->parent[v] = NULL; */
-        network->vertices[v].dist = UNIT_MAX;
-        network->queue.in_queue[v] = false;
-        /* network->avail[v] = UNIT_MAX; */
-    }
-
-    network->vertices[network->source].dist = 0;
-    network->vertices[network->sink].parent = NULL;
-    network->vertices[network->source].avail = UNIT_MAX;
+    uint64_t range = atomic_load(&worker->range);
 
-    network->queue.cursor = -1;
-    network->queue.end = 0;
-    vertex_queue_put(network, network->source);
-
-
-    while (!vertex_queue_empty(network)) {
-        vertex_t index = vertex_queue_pop(network);
-        struct vertex *vertex = &network->vertices[index];
-
-
-        for (struct edge *edge = vertex->adj_tail; edge != NULL; 
-                edge = edge->next_tail) {
-            relax(network, edge);
-        }
-
-        for (struct edge *edge = vertex->adj_head; edge != NULL; 
-                edge = edge->next_head) {
-            relax(network, edge);
+    while (RANGE_BEGIN(range) < RANGE_END(range)) {
+        if (atomic_compare_exchange_weak(&worker->range, &range, 
+                    RANGE(RANGE_BEGIN(range) + 1, RANGE_END(range)))) {
+            *index = RANGE_BEGIN(range);
+            return true;
         }
     }
 
-#ifdef DDEEBBUUGG__
-    for (vertex_t v = 0; v < network->vertex_count; v++) {
-        dprintf("%lld ", network->dist[v]);
-    }
-    dprintf("\n");
-#endif
+    return false;
 }
 
-void 
-pour_flow(struct network *network)
+static bool
+worker_steal(struct worker *worker)
 {
-    vertex_t head_vertex = network->sink;
-    const unit_t flow = network->vertices[network->sink].avail;
-    network->total_flow += flow;
+    struct pool *pool = worker->pool;
 
-    while (head_vertex != network->source) {
-        struct edge *edge = network->vertices[head_vertex].parent;
+    for (int i = 1; i < pool->worker_count; i++) {
+        struct worker *victim = &pool->workers[(worker->id + i) % pool->worker_count];
+        uint64_t range = atomic_load(&victim->range);
 
-        vertex_t neighbor = edge->head == head_vertex ? edge->tail : edge->head;
-        int sgn = neighbor == edge->head ? -1 : 1;
+        while (RANGE_BEGIN(range) < RANGE_END(range)) {
+            uint32_t begin = RANGE_BEGIN(range);
+            uint32_t end = RANGE_END(range);
+            uint32_t split = end - (end - begin + 1) / 2;
 
-        edge->flow += sgn * flow;
-
-        network->total_cost += sgn * flow * edge->cost;
-
-        head_vertex = neighbor;
+            if (atomic_compare_exchange_weak(&victim->range, &range, 
+                        RANGE(begin, split))) {
+                atomic_store(&worker->range, RANGE(split, end));
+                return true;
+            }
+        }
     }
+
+    return false;
 }
 
-void 
-maxflow(struct network *network)
+static void *
+worker_main(void *arg)
 {
+    struct worker *worker = arg;
+    struct pool *pool = worker->pool;
+    uint32_t index;
+
     do {
-        bellman_ford(network);
-        if (network->vertices[network->sink].parent != NULL) {
-            pour_flow(network);
+        while (worker_take(worker, &index)) {
+            pool->answers[index] = solve_tournament(&worker->solver, 
+                                                    &pool->inputs[index]);
         }
+    } while (worker_steal(worker));
 
-    } while (network->vertices[network->sink].parent != NULL);
+    return NULL;
 }
 
-static struct edge *
-add_edge(struct network *network, vertex_t *cursor,
-         vertex_t tail, vertex_t head,
-         unit_t capacity, unit_t cost)
+static void
+print_answer(bool answer)
 {
-    struct edge *edge = &network->edges[*cursor];
-
-    edge->tail = tail;
-    edge->head = head;
-    edge->flow = 0;
-    edge->cost = cost;
-    edge->capacity = capacity;
-
-    edge->next_tail = network->vertices[tail].adj_tail;
-    network->vertices[tail].adj_tail = edge;
-
-    edge->next_head = network->vertices[head].adj_head;
-    network->vertices[head].adj_head = edge;
-
-    (*cursor)++;
-
-    return edge;
+    dprintf("==========================================\n");
+    dprintf("||                  ");
+    printf(answer ? "TAK" : "NIE");
+    dprintf("                 ||");
+    printf("\n");
+    dprintf("==========================================\n");
 }
 
-static bool
-solve_tournament()
+static void
+report_malformed(const struct scanner *scanner, int index)
 {
-    player_idx_t player_count;
-    unit_t budget;
-    fscanf(stdin, "%d %d", &budget, &player_count);
+    fprintf(stderr, "stdin, line %d: case %d malformed: %s\n",
+            scanner_line(scanner), index, scanner->error);
+}
 
-    if (player_count <= 1) {
-        return true;
+/*
+ * Reads every case up front, solves them on `jobs` threads, answers in order.
+ * Nothing is solved when one of them is malformed.
+ */
+static int
+solve_parallel(const struct options *options, struct scanner *scanner,
+               int case_count)
+{
+    struct pool pool = {
+        .options = options,
+        .case_count = case_count,
+        .inputs = valloc(sizeof(struct tournament_input) * max(case_count, 1)),
+        .input_arena = { 0 },
+        .answers = valloc(sizeof(bool) * max(case_count, 1)),
+        .worker_count = options->jobs,
+        .workers = valloc(sizeof(struct worker) * options->jobs),
+    };
+
+    for (int i = 0; i < case_count; i++) {
+        pool.inputs[i].index = i;
+
+        if (!read_tournament(scanner, &pool.inputs[i], &pool.input_arena)) {
+            report_malformed(scanner, i);
+
+            arena_release(&pool.input_arena);
+            free(pool.inputs);
+            free(pool.answers);
+            free(pool.workers);
+            return 1;
+        }
     }
 
-    vertex_t game_count = ((player_count * (player_count - 1)) / 2);
-    unit_t max_points = UNIT_MIN;
+    for (int w = 0; w < pool.worker_count; w++) {
+        struct worker *worker = &pool.workers[w];
 
-    vertex_t player_offset_l = 1;
+        int64_t begin = (int64_t) case_count * w / pool.worker_count;
+        int64_t end = (int64_t) case_count * (w + 1) / pool.worker_count;
 
-    struct network network;
-    /* memset(&network, 0, sizeof(struct network)); */
-
-    network.vertex_count = 1 + player_count + 2;
-    network.edge_count = player_count + game_count + player_count + 1;
-
-    /* alloc once ? */ 
-    network.edges           = valloc(sizeof(struct edge) * network.edge_count);
-    network.vertices        = valloc(sizeof(struct vertex) * network.vertex_count);
-    network.source_player   = valloc(sizeof(struct edge *) * player_count);
-    network.player_limit    = valloc(sizeof(struct edge *) * player_count);
-
-    network.queue.in_queue  = valloc(sizeof(bool) * network.vertex_count);
-    network.queue.queue     = valloc(sizeof(vertex_t) * network.vertex_count);
-
-    for (vertex_t vertex = 0; vertex < network.vertex_count; vertex++) {
-        network.vertices[vertex].adj_head = NULL;
-        network.vertices[vertex].adj_tail = NULL;
+        atomic_init(&worker->range, RANGE(begin, end));
+        worker->id = w;
+        worker->pool = &pool;
+        worker->solver = (struct solver) { .options = options };
     }
 
-#ifdef DDEEBBUUGG__
-    dprintf("netwo\t = %p\n", &network);
-    dprintf("edges\t = %p\n", network.edges);
-    dprintf("srcp \t = %p\n", network.source_player);
-    dprintf("plli \t = %p\n", network.player_limit);
-    dprintf("dist \t = %p\n", network.dist);
-    dprintf("pare \t = %p\n", network.parent);
-#endif
-
-    vertex_t source_vertex = 0;
-    vertex_t limit_vertex = player_offset_l + player_count;
-    vertex_t sink_vertex = player_offset_l + player_count + 1;
-
-    network.sink = sink_vertex;
-    network.source = source_vertex;
-
-#ifdef DDEEBBUUGG
-    dotdebug("digraph { //c \n");
-    dotdebug("\trankdir=LR;\n");
-
-    dotdebug("\t%lld [label=source];\n", source_vertex);
-    dotdebug("\t%lld [label=limit];\n", limit_vertex);
-    dotdebug("\t%lld [label=sink];\n", sink_vertex);
-#endif
-
-    vertex_t cursor = 0;
-    player_idx_t player_a, player_b, winner, loser;
-    unit_t bribe;
-
-    vertex_t player_vertex;
-    for (player_idx_t player_idx = 0; player_idx < player_count; player_idx++) {
-        player_vertex = player_offset_l + player_idx;
+    /* worker 0 runs on the calling thread */
+    for (int w = 1; w < pool.worker_count; w++) {
+        pthread_create(&pool.workers[w].thread, NULL, worker_main, 
+                       &pool.workers[w]);
+    }
 
-        network.source_player[player_idx] = add_edge(&network, &cursor,
-                source_vertex, player_vertex, 0, 0);
+    worker_main(&pool.workers[0]);
 
-        dotdebug("\t%lld [label=\"%lldl\"];\n",
-                player_vertex, player_idx);
+    for (int w = 1; w < pool.worker_count; w++) {
+        pthread_join(pool.workers[w].thread, NULL);
     }
 
+    for (int i = 0; i < case_count; i++) {
+        print_answer(pool.answers[i]);
+    }
 
-    for (vertex_t game_idx = 0; game_idx < game_count; game_idx++) {
-        fscanf(stdin, "%d %d %d %d", 
-               &player_a, &player_b, 
-               &winner, &bribe);
-        
-        loser = winner == player_a ? player_b : player_a;
+    for (int w = 0; w < pool.worker_count; w++) {
+        arena_release(&pool.workers[w].solver.arena);
+    }
 
-        vertex_t winner_vertex = player_offset_l + winner;
-        vertex_t loser_vertex = player_offset_l + loser;
+    arena_release(&pool.input_arena);
+    free(pool.inputs);
+    free(pool.answers);
+    free(pool.workers);
 
-        network.source_player[winner]->capacity += 1;
-        
-        max_points = max(max_points, network.source_player[winner]->capacity);
+    return 0;
+}
 
-        if (bribe > budget) {
-            continue;
+/* one case at a time as read, answers up to a malformed one */
+static int
+solve_sequential(const struct options *options, struct scanner *scanner,
+                 int case_count)
+{
+    struct solver solver = { .options = options };
+    struct arena input_arena = { 0 };
+    struct tournament_input input;
+    int status = 0;
+
+    for (int i = 0; i < case_count; i++) {
+        arena_reset(&input_arena);
+
+        input.index = i;
+        if (!read_tournament(scanner, &input, &input_arena)) {
+            report_malformed(scanner, i);
+            status = 1;
+            break;
         }
 
-        add_edge(&network, &cursor,
-                 winner_vertex, loser_vertex, 1, bribe);
-
-    }   
-
-    for (player_idx_t player_idx = 0; player_idx < player_count; player_idx++) {
-        player_vertex = player_offset_l + player_idx;
-
-        dotdebug("\t%lld [label=p%lld]\n", player_vertex, player_idx);
-
-        vertex_t head = player_idx == 0 ? sink_vertex : limit_vertex;
-
-        network.player_limit[player_idx] = add_edge(
-                &network, &cursor,
-                player_vertex, head, 1, 0);
-
+        print_answer(solve_tournament(&solver, &input));
     }
 
-    network.limit_sink = add_edge(&network, &cursor,
-             limit_vertex, sink_vertex, 1, 0);
+    arena_release(&solver.arena);
+    arena_release(&input_arena);
 
-    bool found = false;
+    return status;
+}
 
-    dprintf("budget = %lld\n", budget);
-    dprintf("max_points = %lld\n", max_points);
-    dprintf("player_count = %lld\n", player_count);
+static void
+usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [-e spfa|dijkstra|scaling|primal-dual]\n"
+            "       [-s linear|binary] [-w] [--no-prune] [-j jobs] [-v]\n"
+            "       [--stats json|csv] [--width auto|wide] [--speculate threads]\n"
+            "       [--layout auto|sparse|dense] < input\n"
+            "       %s [options] --serve socket|-\n", argv0, argv0);
+    exit(2);
+}
 
-    dprintf("======== %d %d\n", cursor, network.edge_count);
-    network.edge_count = cursor;
+static void
+parse_options(struct options *options, int argc, char *const argv[])
+{
+    static const struct option long_options[] = {
+        { "engine",     required_argument, NULL, 'e' },
+        { "search",     required_argument, NULL, 's' },
+        { "warm-start", no_argument,       NULL, 'w' },
+        { "no-prune",   no_argument,       NULL, 'P' },
+        { "layout",     required_argument, NULL, 'L' },
+        { "jobs",       required_argument, NULL, 'j' },
+        { "verbose",    no_argument,       NULL, 'v' },
+        { "stats",      required_argument, NULL, 'S' },
+        { "width",      required_argument, NULL, 'W' },
+        { "serve",      required_argument, NULL, 'R' },
+        { "speculate",  required_argument, NULL, 'T' },
+        { NULL,         0,                 NULL, 0   },
+    };
+
+    options->engine = ENGINE_DIJKSTRA;
+    options->search = SEARCH_BINARY;
+    options->warm_start = false;
+    options->prune = true;
+    options->layout = LAYOUT_AUTO;
+    options->verbose = false;
+    options->jobs = 1;
+    options->speculate = 1;
+    options->stats = STATS_NONE;
+    options->width = WIDTH_AUTO;
+    options->serve = NULL;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "e:s:wj:v", long_options, NULL)) != -1) {
+        switch (opt) {
+        case 'e':
+            if (!engine_by_name(optarg, &options->engine)) {
+                usage(argv[0]);
+            }
+            break;
 
-    for (unit_t limit = player_count / 2; limit <= max_points; limit++) {
-        dprintf("\n");
-        dprintf("limit = %lld\n", limit);
+        case 's':
+            if (strcmp(optarg, "linear") == 0) {
+                options->search = SEARCH_LINEAR;
+            } else if (strcmp(optarg, "binary") == 0) {
+                options->search = SEARCH_BINARY;
+            } else {
+                usage(argv[0]);
+            }
+            break;
 
-        network.total_cost = 0;
-        network.total_flow = 0;
-        network.limit_sink->flow = 0;
-        network.limit_sink->capacity = game_count - limit;
+        case 'w':
+            options->warm_start = true;
+            break;
 
-        for (vertex_t e = 0; e < network.edge_count; e++) {
-            network.edges[e].flow = 0;
-        }
+        case 'P':
+            options->prune = false;
+            break;
 
-        for (player_idx_t player_idx = 0; player_idx < player_count; player_idx++) {
-            unit_t flow = min(network.source_player[player_idx]->capacity,
-                           limit);
-            
-            flow = min(flow, network.limit_sink->capacity - network.limit_sink->flow);
-            
-            if (player_idx != 0) {
-                network.limit_sink->flow += flow;
+        case 'L':
+            if (strcmp(optarg, "auto") == 0) {
+                options->layout = LAYOUT_AUTO;
+            } else if (strcmp(optarg, "sparse") == 0) {
+                options->layout = LAYOUT_SPARSE;
+            } else if (strcmp(optarg, "dense") == 0) {
+                options->layout = LAYOUT_DENSE;
+            } else {
+                usage(argv[0]);
             }
+            break;
 
-            network.source_player[player_idx]->flow = flow;
-            network.player_limit[player_idx]->flow = flow;
-            
-            network.player_limit[player_idx]->capacity = limit;
+        case 'j':
+            options->jobs = atoi(optarg);
+            if (options->jobs <= 0) {
+                options->jobs = sysconf(_SC_NPROCESSORS_ONLN);
+            }
+            break;
 
-            network.total_flow += flow;
-        }
+        case 'v':
+            options->verbose = true;
+            break;
 
-        maxflow(&network);
-        dprintf("spent = %lld\n", network.total_cost);
-        dprintf("total_flow = %d %d\n", network.total_flow, game_count);
+        case 'S':
+            if (strcmp(optarg, "json") == 0) {
+                options->stats = STATS_JSON;
+            } else if (strcmp(optarg, "csv") == 0) {
+                options->stats = STATS_CSV;
+            } else {
+                usage(argv[0]);
+            }
+            break;
 
-        if (network.total_cost <= budget && network.total_flow == game_count) {
-            found = true;
+        case 'W':
+            if (strcmp(optarg, "auto") == 0) {
+                options->width = WIDTH_AUTO;
+            } else if (strcmp(optarg, "wide") == 0) {
+                options->width = WIDTH_WIDE;
+            } else {
+                usage(argv[0]);
+            }
             break;
-        }
-    }
 
-#ifdef DDEEBBUUGG
-    for (vertex_t e = 0; e < network.edge_count; e++) {
-        struct edge *edge = &network.edges[e];
+        case 'T':
+            options->speculate = atoi(optarg);
+            if (options->speculate <= 0) {
+                options->speculate = sysconf(_SC_NPROCESSORS_ONLN);
+            }
+            break;
 
-        dotdebug("\t%lld -> %lld [label=\"%lld, %lld, %lld\"];\n", 
-                 edge->tail, edge->head, 
-                 edge->capacity, edge->cost, edge->flow);
+        case 'R':
+            options->serve = optarg;
+            break;
 
+        default:
+            usage(argv[0]);
+        }
     }
-    dotdebug("}\n");
-#endif
-
-    free(network.source_player);
-    free(network.player_limit);
-    free(network.edges);
-    free(network.vertices);
-
-    return found;
 }
 
 int
-main(int argc, const char *argv[])
+main(int argc, char *argv[])
 {
 #ifdef DDEEBBUUGG
     dot_file = fopen("out.dot", "w");
 #endif
 
-    int n;
-    fscanf(stdin, "%d", &n);
-    for (int i = 0; i < n; i++) {
-        if (solve_tournament()) {
-            dprintf("==========================================\n");
-            dprintf("||                  ");
-            printf("TAK");
-            dprintf("                 ||");
-            printf("\n");
-            dprintf("==========================================\n");
+    struct options options;
+    parse_options(&options, argc, argv);
+
+    int status = 0;
+
+    if (options.serve != NULL) {
+        print_stats_header(options.stats);
+        status = serve(&options);
+    } else {
+        const int64_t started = now_usec();
+        struct scanner scanner;
+        int32_t case_count;
+
+        if (!scanner_open_fd(&scanner, STDIN_FILENO)) {
+            perror("stdin");
+            return 1;
+        }
+
+        if (options.verbose) {
+            fprintf(stderr, "input = %zu bytes, %s, usec = %lld\n",
+                    scanner_left(&scanner), scanner.mapping != NULL ? "mapped" : "read",
+                    (long long) (now_usec() - started));
+        }
+
+        print_stats_header(options.stats);
+
+        /* the shortest case is "\n0 0" */
+        if (scanner_int32(&scanner, &case_count)
+                && (case_count < 0 || (size_t) case_count > scanner_left(&scanner) / 4)) {
+            scanner_fail(&scanner, "more cases than the input holds");
+        }
+
+        if (scanner.error != NULL) {
+            fprintf(stderr, "stdin, line %d: case count malformed: %s\n",
+                    scanner_line(&scanner), scanner.error);
+            status = 1;
+        } else if (options.jobs > 1) {
+            status = solve_parallel(&options, &scanner, case_count);
         } else {
-            dprintf("==========================================\n");
-            dprintf("||                  ");
-            printf("NIE");
-            dprintf("                 ||");
-            printf("\n");
-            dprintf("==========================================\n");
+            status = solve_sequential(&options, &scanner, case_count);
         }
+
+        scanner_close(&scanner);
     }
 
 #ifdef DDEEBBUUGG
     fclose(dot_file);
 #endif
-    return 0;
+    return status;
 }
 
 
@@ -0,0 +1,1501 @@
+/*
+ * Header-only min-cost flow engine, a C stand-in for a template over the
+ * vertex, capacity and cost types. A translation unit instantiates it once
+ * by defining the three types before including this file:
+ *
+ *     #define MCF_VERTEX_T int16_t
+ *     #define MCF_UNIT_T   int16_t
+ *     #define MCF_COST_T   int32_t
+ *     #include "mcf.h"
+ *
+ * Everything instantiated is static, so differently sized engines live in
+ * different translation units side by side. Without MCF_UNIT_T only the
+ * type independent part (counters, engine selection) is declared.
+ */
+#ifndef MCF_H
+#define MCF_H
+
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "arena.h"
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+
+typedef uint64_t bitmask_t;
+
+#define NO_ARC -1
+
+#define BITMASK_BITS (sizeof(bitmask_t) * 8)
+
+#define BITMASK_LEN(bits) \
+    (((bits) + BITMASK_BITS - 1) / BITMASK_BITS)
+
+#define _BIT(bit) \
+    ((bitmask_t) (((bitmask_t) 1) << ((bit) % BITMASK_BITS)))
+
+#define _BITMASK_ELEM(bitmask, bit) \
+    bitmask[(bit) / BITMASK_BITS]
+
+#define BITMASK_SET(bitmask, bit) \
+    _BITMASK_ELEM(bitmask, bit) = _BITMASK_ELEM(bitmask, bit) | _BIT(bit)
+
+#define BITMASK_CLEAR(bitmask, bit) \
+    _BITMASK_ELEM(bitmask, bit) = _BITMASK_ELEM(bitmask, bit) & ~_BIT(bit)
+
+#define BITMASK_HAS(bitmask, bit) \
+    ((_BITMASK_ELEM(bitmask, bit) & _BIT(bit)) == _BIT(bit))
+
+/*
+ * Widest vector the target has, the dense kernel compares this many bytes of
+ * costs at once. Plain GCC vector extensions, so -mavx2 or -mavx512f turn
+ * into the matching instructions; MCF_SCALAR keeps the kernel scalar.
+ */
+#if defined(__AVX512F__)
+#define MCF_VECTOR_BYTES 64
+#elif defined(__AVX2__)
+#define MCF_VECTOR_BYTES 32
+#else
+#define MCF_VECTOR_BYTES 16
+#endif
+
+/* largest value of a signed integer type */
+#define MCF_MAX_OF(type) \
+    ((type) ((UINT64_C(1) << (sizeof(type) * 8 - 1)) - 1))
+
+enum engine {
+    ENGINE_SPFA,
+    ENGINE_DIJKSTRA,
+    ENGINE_COST_SCALING,
+    ENGINE_PRIMAL_DUAL,
+};
+
+/* engine by its command line name, false for an unknown one */
+static inline bool
+engine_by_name(const char *name, enum engine *engine)
+{
+    if (strcmp(name, "spfa") == 0) {
+        *engine = ENGINE_SPFA;
+    } else if (strcmp(name, "dijkstra") == 0) {
+        *engine = ENGINE_DIJKSTRA;
+    } else if (strcmp(name, "scaling") == 0) {
+        *engine = ENGINE_COST_SCALING;
+    } else if (strcmp(name, "primal-dual") == 0) {
+        *engine = ENGINE_PRIMAL_DUAL;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+#define COUNTERS(X) \
+    X(bellman_ford) \
+    X(dijkstra) \
+    X(arc_scans) \
+    X(relaxations) \
+    X(queue_pushes) \
+    X(queue_pops) \
+    X(augmentations) \
+    X(pushes) \
+    X(relabels) \
+    X(limits) \
+    X(warm_starts) \
+    X(bound_skips) \
+    X(flow_checks) \
+    X(flow_rejects) \
+    X(cut_short) \
+    X(dropped_games) \
+    X(fixed_players) \
+    X(speculated) \
+    X(cancelled) \
+    X(build_usec) \
+    X(warm_usec) \
+    X(flow_usec)
+
+/*
+ * Hot path counters, always counted as they cost one increment each. The
+ * timers are only read when stats are requested.
+ */
+struct counters {
+#define X(name) int64_t name;
+    COUNTERS(X)
+#undef X
+};
+
+static inline void
+counters_add(struct counters *to, const struct counters *from)
+{
+#define X(name) to->name += from->name;
+    COUNTERS(X)
+#undef X
+}
+
+static inline int64_t
+now_usec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+#endif /* MCF_H */
+
+#if defined(MCF_UNIT_T) && !defined(MCF_INSTANCE)
+#define MCF_INSTANCE
+
+/* edges and arcs are counted in 32 bits whatever the unit types are */
+typedef MCF_VERTEX_T vertex_t;
+typedef int32_t edge_t;
+typedef int32_t arc_t;
+typedef MCF_UNIT_T unit_t;
+typedef MCF_COST_T cost_t;
+
+#define UNIT_MAX MCF_MAX_OF(unit_t)
+#define UNIT_MIN (-UNIT_MAX - 1)
+#define COST_MAX MCF_MAX_OF(cost_t)
+
+#if defined(__GNUC__) && !defined(MCF_SCALAR)
+#define MCF_LANES ((int) (MCF_VECTOR_BYTES / sizeof(cost_t)))
+
+typedef cost_t cost_lanes __attribute__ ((vector_size (MCF_VECTOR_BYTES)));
+typedef unit_t unit_lanes __attribute__ ((vector_size (MCF_LANES * sizeof(unit_t))));
+#endif
+
+/* an edge as added, the solver works on the residual arcs laid out from it */
+struct edge {
+    vertex_t tail; /* from */
+    vertex_t head; /* to */
+
+    unit_t capacity;
+    cost_t cost;
+
+} __attribute__ ((aligned (ALIGN_TO)));
+
+struct vertex_queue {
+    vertex_t cursor;
+    vertex_t end;
+
+    bitmask_t *in_queue;
+    vertex_t *queue;
+
+} __attribute__ ((aligned (ALIGN_TO)));
+
+/* indexed binary min-heap keyed by dist[v] */
+struct vertex_heap {
+    vertex_t size;
+
+    vertex_t *heap;
+    vertex_t *pos; /* -1 when not in heap */
+
+} __attribute__ ((aligned (ALIGN_TO)));
+
+struct network {
+    vertex_t vertex_count;
+    edge_t edge_count;
+
+    cost_t total_cost;
+    unit_t total_flow;
+
+    struct counters counters;
+
+    vertex_t source;
+    vertex_t sink;
+
+    struct edge *edges;
+
+    /*
+     * forward-star layout, the residual arcs leaving v are
+     * first[v] .. first[v + 1] - 1, both directions of an edge side by side
+     * with the other arcs of their tail
+     */
+    arc_t *first;
+    vertex_t *arc_head;
+    cost_t *arc_cost;
+    unit_t *arc_residual;
+    arc_t *arc_reverse;
+    arc_t *edge_arc; /* forward arc of every edge */
+
+    /*
+     * Dense block: every vertex in dense_first .. dense_first + dense_count - 1
+     * starts its arcs with one slot per block vertex, in order, so that the
+     * arc to dense_first + k is first[v] + k. Slots no edge uses hold a dead
+     * arc without residual capacity.
+     */
+    vertex_t dense_first;
+    vertex_t dense_count;
+    bitmask_t *dense_claimed;
+
+    cost_t *dist;
+    unit_t *avail;
+    cost_t *potential;
+    arc_t *parent;
+
+    /*
+     * potential[] gives no residual arc a negative reduced cost, but for the
+     * arcs leaving stale vertices, which changed since the last solve
+     */
+    bool potential_valid;
+    bitmask_t *stale;
+
+    /* cost scaling push-relabel */
+    int64_t *price;
+    unit_t *excess;
+    arc_t *current;
+
+    struct vertex_queue queue;
+    struct vertex_heap heap;
+
+    enum engine engine;
+
+    /* successive shortest path engines give up once sure to end above it */
+    cost_t cost_limit;
+    bool cut_short;
+
+    /* set by another thread, every engine gives up at its next check */
+    _Atomic bool *cancel;
+
+} __attribute__ ((aligned (ALIGN_TO)));
+
+static inline vertex_t
+arc_tail(const struct network *network, arc_t arc)
+{
+    return network->arc_head[network->arc_reverse[arc]];
+}
+
+static inline unit_t
+edge_flow(const struct network *network, edge_t edge)
+{
+    arc_t arc = network->edge_arc[edge];
+    return network->arc_residual[network->arc_reverse[arc]];
+}
+
+static inline unit_t
+edge_capacity(const struct network *network, edge_t edge)
+{
+    arc_t arc = network->edge_arc[edge];
+    return network->arc_residual[arc] 
+        + network->arc_residual[network->arc_reverse[arc]];
+}
+
+static inline void
+edge_set(struct network *network, edge_t edge, unit_t capacity, unit_t flow)
+{
+    arc_t arc = network->edge_arc[edge];
+
+    network->arc_residual[arc] = capacity - flow;
+    network->arc_residual[network->arc_reverse[arc]] = flow;
+    network->potential_valid = false;
+}
+
+static inline void
+vertex_queue_put(struct network *network, vertex_t vertex)
+{
+    struct vertex_queue *queue = &network->queue;
+    
+    if (BITMASK_HAS(queue->in_queue, vertex)) {
+        return;
+    }
+
+    if (queue->cursor == -1) {
+        queue->cursor = 0;
+        queue->end = 0;
+        queue->queue[0] = vertex;
+    } else {
+        queue->end = (queue->end + 1) % network->vertex_count;
+        queue->queue[queue->end] = vertex;
+    }
+
+    BITMASK_SET(queue->in_queue, vertex);
+    network->counters.queue_pushes++;
+}
+
+static inline bool
+vertex_queue_empty(struct network *network)
+{
+    struct vertex_queue *queue = &network->queue;
+    return queue->cursor == -1;
+}
+
+static inline vertex_t
+vertex_queue_pop(struct network *network) 
+{
+    struct vertex_queue *queue = &network->queue;
+
+    vertex_t vertex = queue->queue[queue->cursor];
+    if (queue->cursor == queue->end) {
+        queue->cursor = -1;
+    } else {
+        queue->cursor = (queue->cursor + 1) % network->vertex_count;
+    }
+
+    BITMASK_CLEAR(queue->in_queue, vertex);
+    network->counters.queue_pops++;
+    return vertex;
+}
+
+static inline void
+vertex_queue_reset(struct network *network)
+{
+    network->queue.cursor = -1;
+    network->queue.end = 0;
+
+    memset(network->queue.in_queue, 0, 
+           sizeof(bitmask_t) * BITMASK_LEN(network->vertex_count));
+}
+
+static inline void
+vertex_heap_swap(struct network *network, vertex_t a, vertex_t b)
+{
+    struct vertex_heap *heap = &network->heap;
+
+    vertex_t tmp = heap->heap[a];
+    heap->heap[a] = heap->heap[b];
+    heap->heap[b] = tmp;
+
+    heap->pos[heap->heap[a]] = a;
+    heap->pos[heap->heap[b]] = b;
+}
+
+static inline cost_t
+vertex_heap_key(struct network *network, vertex_t slot)
+{
+    return network->dist[network->heap.heap[slot]];
+}
+static inline void
+vertex_heap_sift_up(struct network *network, vertex_t slot)
+{
+    while (slot > 0) {
+        vertex_t parent = (slot - 1) / 2;
+
+        if (vertex_heap_key(network, parent) <= vertex_heap_key(network, slot)) {
+            break;
+        }
+
+        vertex_heap_swap(network, parent, slot);
+        slot = parent;
+    }
+}
+
+static inline void
+vertex_heap_sift_down(struct network *network, vertex_t slot)
+{
+    struct vertex_heap *heap = &network->heap;
+
+    for (;;) {
+        vertex_t smallest = slot;
+        vertex_t left = 2 * slot + 1;
+        vertex_t right = left + 1;
+
+        if (left < heap->size &&
+                vertex_heap_key(network, left) < vertex_heap_key(network, smallest)) {
+            smallest = left;
+        }
+        if (right < heap->size &&
+                vertex_heap_key(network, right) < vertex_heap_key(network, smallest)) {
+            smallest = right;
+        }
+
+        if (smallest == slot) {
+            break;
+        }
+
+        vertex_heap_swap(network, slot, smallest);
+        slot = smallest;
+    }
+}
+
+/* inserts vertex or decreases its key after dist[vertex] dropped */
+static inline void
+vertex_heap_put(struct network *network, vertex_t vertex)
+{
+    struct vertex_heap *heap = &network->heap;
+
+    if (heap->pos[vertex] == -1) {
+        heap->pos[vertex] = heap->size;
+        heap->heap[heap->size] = vertex;
+        heap->size++;
+
+        network->counters.queue_pushes++;
+    }
+
+    vertex_heap_sift_up(network, heap->pos[vertex]);
+}
+
+static inline vertex_t
+vertex_heap_pop(struct network *network)
+{
+    struct vertex_heap *heap = &network->heap;
+    vertex_t vertex = heap->heap[0];
+
+    heap->size--;
+    if (heap->size > 0) {
+        vertex_heap_swap(network, 0, heap->size);
+        vertex_heap_sift_down(network, 0);
+    }
+
+    heap->pos[vertex] = -1;
+    network->counters.queue_pops++;
+    return vertex;
+}
+
+
+static inline void 
+relax(struct network *network, vertex_t tail, arc_t arc)
+{
+    unit_t avail = network->arc_residual[arc];
+
+    if (avail <= 0) {
+        return;
+    }
+
+    vertex_t head = network->arc_head[arc];
+    cost_t d = network->dist[tail] + network->arc_cost[arc];
+
+    if (network->dist[head] > d) {
+        network->dist[head] = d;
+        network->parent[head] = arc;
+        network->avail[head] = min(avail, network->avail[tail]);
+        network->counters.relaxations++;
+
+        vertex_queue_put(network, head);
+    }
+}
+
+static inline void
+relax_reduced(struct network *network, vertex_t tail, arc_t arc)
+{
+    unit_t avail = network->arc_residual[arc];
+
+    if (avail <= 0) {
+        return;
+    }
+
+    vertex_t head = network->arc_head[arc];
+    cost_t d = network->dist[tail] + network->arc_cost[arc] 
+        + network->potential[tail] - network->potential[head];
+
+    if (network->dist[head] > d) {
+        network->dist[head] = d;
+        network->parent[head] = arc;
+        network->avail[head] = min(avail, network->avail[tail]);
+        network->counters.relaxations++;
+
+        vertex_heap_put(network, head);
+    }
+}
+
+static inline bool
+in_dense(const struct network *network, vertex_t vertex)
+{
+    return vertex >= network->dense_first
+        && vertex < network->dense_first + network->dense_count;
+}
+
+#ifdef MCF_LANES
+static inline bool
+lanes_any(cost_lanes lanes)
+{
+    uint64_t words[sizeof(cost_lanes) / sizeof(uint64_t)];
+    uint64_t any = 0;
+
+    memcpy(words, &lanes, sizeof(cost_lanes));
+
+    for (size_t i = 0; i < sizeof(cost_lanes) / sizeof(uint64_t); i++) {
+        any |= words[i];
+    }
+
+    return any != 0;
+}
+#endif
+
+/*
+ * Relaxes the dense slots of a block vertex. Their heads are consecutive, so
+ * dist[] and potential[] are loaded MCF_LANES at a time without a gather and
+ * compared in one go; only the lanes that improved are updated one by one.
+ * Returns the first arc left for the scalar loop.
+ */
+static inline arc_t
+relax_dense(struct network *network, vertex_t tail, bool reduced)
+{
+    arc_t arc = network->first[tail];
+
+    if (!in_dense(network, tail)) {
+        return arc;
+    }
+
+    const arc_t end = arc + network->dense_count;
+
+#ifdef MCF_LANES
+    /* the dense heads from the first on, lane `arc - first` of them */
+    const arc_t first = arc;
+    const cost_t *dist = &network->dist[network->dense_first];
+    const cost_t *potential = &network->potential[network->dense_first];
+    const cost_t offset = network->dist[tail]
+        + (reduced ? network->potential[tail] : 0);
+
+    for (; arc + MCF_LANES <= end; arc += MCF_LANES) {
+        cost_lanes cost, head_dist, head_potential;
+        unit_lanes residual;
+
+        memcpy(&cost, &network->arc_cost[arc], sizeof(cost_lanes));
+        memcpy(&residual, &network->arc_residual[arc], sizeof(unit_lanes));
+        memcpy(&head_dist, &dist[arc - first], sizeof(cost_lanes));
+
+        cost_lanes d = cost + offset;
+
+        if (reduced) {
+            memcpy(&head_potential, &potential[arc - first], sizeof(cost_lanes));
+            d -= head_potential;
+        }
+
+        cost_lanes improved = (__builtin_convertvector(residual, cost_lanes) > 0)
+            & (d < head_dist);
+
+        if (!lanes_any(improved)) {
+            continue;
+        }
+
+        for (int lane = 0; lane < MCF_LANES; lane++) {
+            if (!improved[lane]) {
+                continue;
+            }
+
+            vertex_t head = network->arc_head[arc + lane];
+
+            network->dist[head] = d[lane];
+            network->parent[head] = arc + lane;
+            network->avail[head] = min(network->arc_residual[arc + lane],
+                                       network->avail[tail]);
+            network->counters.relaxations++;
+
+            if (reduced) {
+                vertex_heap_put(network, head);
+            } else {
+                vertex_queue_put(network, head);
+            }
+        }
+    }
+#endif
+
+    for (; arc < end; arc++) {
+        if (reduced) {
+            relax_reduced(network, tail, arc);
+        } else {
+            relax(network, tail, arc);
+        }
+    }
+
+    return arc;
+}
+
+static inline void
+spfa(struct network *network)
+{
+    while (!vertex_queue_empty(network)) {
+        vertex_t vertex = vertex_queue_pop(network);
+
+        network->counters.arc_scans += network->first[vertex + 1] 
+            - network->first[vertex];
+
+        for (arc_t arc = relax_dense(network, vertex, false);
+                arc < network->first[vertex + 1]; arc++) {
+            relax(network, vertex, arc);
+        }
+    }
+}
+
+static inline void
+bellman_ford_from(struct network *network, vertex_t start, vertex_t target)
+{
+    for (vertex_t v = 0; v < network->vertex_count; v++) {
+        network->dist[v] = COST_MAX;
+    }
+
+    vertex_queue_reset(network);
+
+    network->dist[start] = 0;
+    network->parent[target] = NO_ARC;
+    network->avail[start] = UNIT_MAX;
+
+    vertex_queue_put(network, start);
+
+    spfa(network);
+    network->counters.bellman_ford++;
+
+#ifdef DDEEBBUUGG__
+    for (vertex_t v = 0; v < network->vertex_count; v++) {
+        dprintf("%lld ", network->dist[v]);
+    }
+    dprintf("\n");
+#endif
+}
+
+static inline void
+bellman_ford(struct network *network)
+{
+    bellman_ford_from(network, network->source, network->sink);
+}
+
+/*
+ * Johnson's reweighting: shortest distances from a virtual root joined to
+ * every vertex by a zero-cost arc. The residual network has no negative
+ * cycles, so afterwards every residual arc has a non-negative reduced cost.
+ */
+static inline void
+johnson_potentials(struct network *network)
+{
+    vertex_queue_reset(network);
+
+    for (vertex_t v = 0; v < network->vertex_count; v++) {
+        network->dist[v] = 0;
+        network->avail[v] = UNIT_MAX;
+    }
+
+    for (vertex_t v = 0; v < network->vertex_count; v++) {
+        vertex_queue_put(network, v);
+    }
+
+    spfa(network);
+    network->counters.bellman_ford++;
+
+    memcpy(network->potential, network->dist, 
+           sizeof(cost_t) * network->vertex_count);
+}
+
+/*
+ * Potentials for the engines on reduced costs. Johnson's on a cold start;
+ * warm, the last ones hold for every arc but those leaving stale vertices, so
+ * only these seed the queue and whatever they pull down is corrected from
+ * there on.
+ */
+static inline void
+repair_potentials(struct network *network)
+{
+    if (!network->potential_valid) {
+        johnson_potentials(network);
+        network->potential_valid = true;
+        return;
+    }
+
+    vertex_queue_reset(network);
+
+    memcpy(network->dist, network->potential,
+           sizeof(cost_t) * network->vertex_count);
+
+    for (vertex_t v = 0; v < network->vertex_count; v++) {
+        if (BITMASK_HAS(network->stale, v)) {
+            network->avail[v] = UNIT_MAX;
+            vertex_queue_put(network, v);
+        }
+    }
+
+    spfa(network);
+    network->counters.bellman_ford++;
+
+    memcpy(network->potential, network->dist,
+           sizeof(cost_t) * network->vertex_count);
+}
+
+/* 
+ * Shortest path on reduced costs, stops as soon as the sink is settled.
+ * Potentials are advanced by min(dist, dist[sink]) which keeps reduced costs
+ * non-negative for vertices which were not settled (or not reached at all).
+ */
+static inline void
+dijkstra(struct network *network)
+{
+    for (vertex_t v = 0; v < network->vertex_count; v++) {
+        network->dist[v] = COST_MAX;
+        network->heap.pos[v] = -1;
+    }
+
+    network->heap.size = 0;
+    network->counters.dijkstra++;
+
+    network->dist[network->source] = 0;
+    network->parent[network->sink] = NO_ARC;
+    network->avail[network->source] = UNIT_MAX;
+
+    vertex_heap_put(network, network->source);
+
+    while (network->heap.size > 0) {
+        vertex_t vertex = vertex_heap_pop(network);
+
+        if (vertex == network->sink) {
+            break;
+        }
+
+        network->counters.arc_scans += network->first[vertex + 1] 
+            - network->first[vertex];
+
+        for (arc_t arc = relax_dense(network, vertex, true);
+                arc < network->first[vertex + 1]; arc++) {
+            relax_reduced(network, vertex, arc);
+        }
+    }
+
+    cost_t sink_dist = network->dist[network->sink];
+    if (sink_dist == COST_MAX) {
+        return;
+    }
+
+    for (vertex_t v = 0; v < network->vertex_count; v++) {
+        network->potential[v] += min(network->dist[v], sink_dist);
+    }
+}
+
+/* pushes flow along the parent chain leading from `from` to `to` */
+static inline void
+augment(struct network *network, vertex_t from, vertex_t to, unit_t flow)
+{
+    vertex_t vertex = to;
+
+    network->counters.augmentations++;
+
+    while (vertex != from) {
+        arc_t arc = network->parent[vertex];
+        arc_t reverse = network->arc_reverse[arc];
+
+        network->arc_residual[arc] -= flow;
+        network->arc_residual[reverse] += flow;
+        BITMASK_SET(network->stale, vertex);
+
+        network->total_cost += (cost_t) flow * network->arc_cost[arc];
+
+        vertex = network->arc_head[reverse];
+    }
+}
+
+static inline void
+pour_flow(struct network *network)
+{
+    const unit_t flow = network->avail[network->sink];
+    network->total_flow += flow;
+
+    augment(network, network->source, network->sink, flow);
+}
+
+static inline bool
+cancelled(const struct network *network)
+{
+    return network->cancel != NULL
+        && atomic_load_explicit(network->cancel, memory_order_relaxed);
+}
+
+/*
+ * Shortest paths only get longer as the flow grows, so once the flow costs
+ * more than the limit and the last path was not negative, the final flow
+ * will cost more too. A cancelled solve stops here as well, without being
+ * cut short.
+ */
+static inline bool
+over_cost_limit(struct network *network, cost_t path_cost)
+{
+    if (cancelled(network)) {
+        return true;
+    }
+
+    if (network->total_cost <= network->cost_limit || path_cost < 0) {
+        return false;
+    }
+
+    network->cut_short = true;
+    return true;
+}
+
+/* the length of the path found by the last dijkstra() in original costs */
+static inline cost_t
+path_cost(const struct network *network)
+{
+    return network->potential[network->sink] - network->potential[network->source];
+}
+
+/* 
+ * With `priced` only residual arcs of zero reduced cost count, which are
+ * exactly the arcs on shortest paths once potentials were advanced.
+ */
+static inline bool
+arc_open(const struct network *network, vertex_t tail, arc_t arc, bool priced)
+{
+    if (network->arc_residual[arc] <= 0) {
+        return false;
+    }
+
+    return !priced || network->arc_cost[arc] + network->potential[tail] 
+        == network->potential[network->arc_head[arc]];
+}
+
+/* breadth first levels over the open arcs, dist[] holds the level */
+static inline bool
+bfs_levels(struct network *network, bool priced)
+{
+    vertex_t *queue = network->queue.queue;
+    vertex_t head = 0, tail = 0;
+
+    for (vertex_t v = 0; v < network->vertex_count; v++) {
+        network->dist[v] = COST_MAX;
+    }
+
+    network->dist[network->source] = 0;
+    queue[tail++] = network->source;
+
+    while (head < tail) {
+        vertex_t vertex = queue[head++];
+
+        for (arc_t arc = network->first[vertex]; arc < network->first[vertex + 1];
+                arc++) {
+            vertex_t next = network->arc_head[arc];
+
+            if (network->dist[next] == COST_MAX && 
+                    arc_open(network, vertex, arc, priced)) {
+                network->dist[next] = network->dist[vertex] + 1;
+                queue[tail++] = next;
+            }
+        }
+    }
+
+    return network->dist[network->sink] != COST_MAX;
+}
+
+/* 
+ * Blocking flow over the level graph, iterative depth first search with a
+ * current arc per vertex. Vertices found to be dead ends leave the level
+ * graph by dropping their level.
+ */
+static inline void
+blocking_flow(struct network *network, bool priced)
+{
+    memcpy(network->current, network->first, sizeof(arc_t) * network->vertex_count);
+
+    vertex_t vertex = network->source;
+
+    for (;;) {
+        if (vertex == network->sink) {
+            unit_t flow = UNIT_MAX;
+
+            for (vertex_t v = network->sink; v != network->source; ) {
+                arc_t arc = network->parent[v];
+                flow = min(flow, network->arc_residual[arc]);
+                v = arc_tail(network, arc);
+            }
+
+            augment(network, network->source, network->sink, flow);
+            network->total_flow += flow;
+
+            vertex = network->source;
+            continue;
+        }
+
+        arc_t arc = network->current[vertex];
+        for (; arc < network->first[vertex + 1]; arc++) {
+            vertex_t next = network->arc_head[arc];
+
+            if (network->dist[next] == network->dist[vertex] + 1 &&
+                    arc_open(network, vertex, arc, priced)) {
+                break;
+            }
+        }
+        network->current[vertex] = arc;
+
+        if (arc < network->first[vertex + 1]) {
+            network->parent[network->arc_head[arc]] = arc;
+            vertex = network->arc_head[arc];
+            continue;
+        }
+
+        if (vertex == network->source) {
+            return;
+        }
+
+        network->dist[vertex] = COST_MAX;
+        vertex = arc_tail(network, network->parent[vertex]);
+        network->current[vertex]++;
+    }
+}
+
+/* cost oblivious Dinic, tops the current flow up to a maximum flow */
+static inline void
+dinic(struct network *network)
+{
+    while (!cancelled(network) && bfs_levels(network, false)) {
+        blocking_flow(network, false);
+    }
+}
+
+/*
+ * Primal-dual: every Dijkstra pass advances the potentials, after which all
+ * shortest paths are made of zero reduced cost arcs. Those are saturated
+ * Dinic-style before the next pass instead of one path per pass.
+ */
+static inline void
+primal_dual(struct network *network)
+{
+    repair_potentials(network);
+
+    for (;;) {
+        dijkstra(network);
+        if (network->parent[network->sink] == NO_ARC) {
+            break;
+        }
+
+        while (bfs_levels(network, true)) {
+            blocking_flow(network, true);
+        }
+
+        if (over_cost_limit(network, path_cost(network))) {
+            break;
+        }
+    }
+}
+
+static inline int64_t
+reduced_cost(const struct network *network, vertex_t tail, arc_t arc, int64_t scale)
+{
+    return network->arc_cost[arc] * scale
+        + network->price[tail] - network->price[network->arc_head[arc]];
+}
+
+static inline void
+push(struct network *network, vertex_t tail, arc_t arc, unit_t flow)
+{
+    vertex_t head = network->arc_head[arc];
+
+    network->arc_residual[arc] -= flow;
+    network->arc_residual[network->arc_reverse[arc]] += flow;
+
+    network->excess[tail] -= flow;
+    network->excess[head] += flow;
+
+    network->counters.pushes++;
+
+    if (network->excess[head] > 0) {
+        vertex_queue_put(network, head);
+    }
+}
+
+/* lowers the price of a vertex just enough to make one residual arc admissible */
+static inline void
+relabel(struct network *network, vertex_t vertex, int64_t scale, int64_t epsilon)
+{
+    int64_t price = INT64_MIN;
+
+    for (arc_t arc = network->first[vertex]; arc < network->first[vertex + 1];
+            arc++) {
+        if (network->arc_residual[arc] > 0) {
+            price = max(price, network->price[network->arc_head[arc]] 
+                               - network->arc_cost[arc] * scale);
+        }
+    }
+
+    network->price[vertex] = price - epsilon;
+    network->current[vertex] = network->first[vertex];
+
+    network->counters.relabels++;
+}
+
+/*
+ * Turns an epsilon * alpha optimal circulation into an epsilon optimal one:
+ * saturate every arc with negative reduced cost, then discharge the excess
+ * this creates with FIFO push-relabel over admissible arcs.
+ */
+static inline void
+refine(struct network *network, int64_t scale, int64_t epsilon)
+{
+    vertex_queue_reset(network);
+
+    for (vertex_t v = 0; v < network->vertex_count; v++) {
+        network->excess[v] = 0;
+        network->current[v] = network->first[v];
+    }
+
+    for (vertex_t v = 0; v < network->vertex_count; v++) {
+        for (arc_t arc = network->first[v]; arc < network->first[v + 1]; arc++) {
+            unit_t residual = network->arc_residual[arc];
+
+            if (residual > 0 && reduced_cost(network, v, arc, scale) < 0) {
+                push(network, v, arc, residual);
+            }
+        }
+    }
+
+    while (!vertex_queue_empty(network)) {
+        vertex_t vertex = vertex_queue_pop(network);
+
+        while (network->excess[vertex] > 0) {
+            arc_t arc = network->current[vertex];
+
+            if (arc == network->first[vertex + 1]) {
+                relabel(network, vertex, scale, epsilon);
+                continue;
+            }
+
+            if (network->arc_residual[arc] > 0 && 
+                    reduced_cost(network, vertex, arc, scale) < 0) {
+                push(network, vertex, arc, 
+                     min(network->excess[vertex], network->arc_residual[arc]));
+            } else {
+                network->current[vertex]++;
+            }
+        }
+    }
+}
+
+/*
+ * Goldberg-Tarjan cost scaling. Dinic first settles the flow value, then
+ * the residual network is brought to a minimum cost circulation. Costs are
+ * scaled by vertex_count + 1 so that 1-optimality in scaled units means
+ * optimality in the original ones.
+ */
+static inline void
+cost_scaling(struct network *network)
+{
+    const int64_t scale = network->vertex_count + 1;
+    const int64_t alpha = 8;
+
+    dinic(network);
+
+    int64_t epsilon = 0;
+    for (arc_t arc = 0; arc < network->first[network->vertex_count]; arc++) {
+        epsilon = max(epsilon, network->arc_cost[arc] * scale);
+    }
+
+    memset(network->price, 0, sizeof(int64_t) * network->vertex_count);
+
+    while (epsilon > 1 && !cancelled(network)) {
+        epsilon = max(1, epsilon / alpha);
+        refine(network, scale, epsilon);
+    }
+
+    network->total_cost = 0;
+    for (edge_t e = 0; e < network->edge_count; e++) {
+        network->total_cost += (cost_t) edge_flow(network, e) * network->edges[e].cost;
+    }
+}
+
+static inline void
+maxflow(struct network *network)
+{
+    switch (network->engine) {
+    case ENGINE_SPFA:
+        do {
+            bellman_ford(network);
+            if (network->parent[network->sink] != NO_ARC) {
+                pour_flow(network);
+
+                if (over_cost_limit(network, network->dist[network->sink])) {
+                    break;
+                }
+            }
+
+        } while (network->parent[network->sink] != NO_ARC);
+        break;
+
+    case ENGINE_DIJKSTRA:
+        repair_potentials(network);
+
+        do {
+            dijkstra(network);
+            if (network->parent[network->sink] != NO_ARC) {
+                pour_flow(network);
+
+                if (over_cost_limit(network, path_cost(network))) {
+                    break;
+                }
+            }
+
+        } while (network->parent[network->sink] != NO_ARC);
+        break;
+
+    case ENGINE_COST_SCALING:
+        cost_scaling(network);
+        break;
+
+    case ENGINE_PRIMAL_DUAL:
+        primal_dual(network);
+        break;
+    }
+
+    /* dijkstra() keeps potentials in step with its own augmentations */
+    if (network->engine == ENGINE_DIJKSTRA
+            || network->engine == ENGINE_PRIMAL_DUAL) {
+        memset(network->stale, 0,
+               sizeof(bitmask_t) * BITMASK_LEN(network->vertex_count));
+    } else {
+        network->potential_valid = false;
+    }
+}
+
+/* a dense block of `dense_count` vertices from `dense_first` on, if not 0 */
+static inline void
+network_init(struct network *network, struct arena *arena,
+             vertex_t vertex_count, edge_t edge_count,
+             vertex_t dense_first, vertex_t dense_count)
+{
+    const size_t dense_slots = (size_t) dense_count * dense_count;
+    const size_t arc_count = 2 * (size_t) edge_count + dense_slots;
+
+    network->vertex_count = vertex_count;
+    network->edge_count = 0;
+    memset(&network->counters, 0, sizeof(struct counters));
+
+    network->cost_limit = COST_MAX;
+    network->cut_short = false;
+    network->cancel = NULL;
+
+    network->dense_first = dense_first;
+    network->dense_count = dense_count;
+    network->dense_claimed  = arena_alloc(arena, 
+            sizeof(bitmask_t) * BITMASK_LEN(dense_slots));
+
+    network->edges          = arena_alloc(arena, sizeof(struct edge) * edge_count);
+
+    network->first          = arena_alloc(arena, sizeof(arc_t) * (vertex_count + 1));
+    network->arc_head       = arena_alloc(arena, sizeof(vertex_t) * arc_count);
+    network->arc_cost       = arena_alloc(arena, sizeof(cost_t) * arc_count);
+    network->arc_residual   = arena_alloc(arena, sizeof(unit_t) * arc_count);
+    network->arc_reverse    = arena_alloc(arena, sizeof(arc_t) * arc_count);
+    network->edge_arc       = arena_alloc(arena, sizeof(arc_t) * edge_count);
+
+    network->dist           = arena_alloc(arena, sizeof(cost_t) * vertex_count);
+    network->avail          = arena_alloc(arena, sizeof(unit_t) * vertex_count);
+    network->potential      = arena_alloc(arena, sizeof(cost_t) * vertex_count);
+    network->parent         = arena_alloc(arena, sizeof(arc_t) * vertex_count);
+    network->potential_valid = false;
+    network->stale          = arena_alloc(arena,
+            sizeof(bitmask_t) * BITMASK_LEN(vertex_count));
+
+    network->price          = arena_alloc(arena, sizeof(int64_t) * vertex_count);
+    network->excess         = arena_alloc(arena, sizeof(unit_t) * vertex_count);
+    network->current        = arena_alloc(arena, sizeof(arc_t) * vertex_count);
+
+    network->queue.in_queue = arena_alloc(arena, 
+            sizeof(bitmask_t) * BITMASK_LEN(vertex_count));
+    network->queue.queue    = arena_alloc(arena, sizeof(vertex_t) * vertex_count);
+
+    network->heap.heap      = arena_alloc(arena, sizeof(vertex_t) * vertex_count);
+    network->heap.pos       = arena_alloc(arena, sizeof(vertex_t) * vertex_count);
+}
+
+static inline edge_t
+add_edge(struct network *network, edge_t *cursor,
+         vertex_t tail, vertex_t head,
+         unit_t capacity, cost_t cost)
+{
+    struct edge *edge = &network->edges[*cursor];
+
+    edge->tail = tail;
+    edge->head = head;
+    edge->cost = cost;
+    edge->capacity = capacity;
+
+    return (*cursor)++;
+}
+
+/* 
+ * Claims the dense slot of an arc tail -> head for it. Parallel arcs find the
+ * slot taken and go with the arcs outside the block.
+ */
+static inline bool
+claim_dense(struct network *network, vertex_t tail, vertex_t head)
+{
+    if (!in_dense(network, tail) || !in_dense(network, head)) {
+        return false;
+    }
+
+    size_t slot = (size_t) (tail - network->dense_first) * network->dense_count
+        + (head - network->dense_first);
+
+    if (BITMASK_HAS(network->dense_claimed, slot)) {
+        return false;
+    }
+
+    BITMASK_SET(network->dense_claimed, slot);
+    return true;
+}
+
+/* 
+ * Lays the edges added so far out as forward-star arrays, counting sort of
+ * both residual arcs of every edge by their tail, arcs within the dense block
+ * going to their slot instead. Flow starts at zero.
+ */
+static inline void
+network_layout(struct network *network)
+{
+    arc_t *first = network->first;
+    const vertex_t dense_count = network->dense_count;
+    const size_t claimed_size = sizeof(bitmask_t) 
+        * BITMASK_LEN((size_t) dense_count * dense_count);
+
+    memset(first, 0, sizeof(arc_t) * (network->vertex_count + 1));
+    memset(network->dense_claimed, 0, claimed_size);
+    memset(network->stale, 0,
+           sizeof(bitmask_t) * BITMASK_LEN(network->vertex_count));
+    network->potential_valid = false;
+
+    for (edge_t e = 0; e < network->edge_count; e++) {
+        vertex_t tail = network->edges[e].tail;
+        vertex_t head = network->edges[e].head;
+
+        if (!claim_dense(network, tail, head)) {
+            first[tail + 1]++;
+        }
+        if (!claim_dense(network, head, tail)) {
+            first[head + 1]++;
+        }
+    }
+
+    for (vertex_t v = 0; v < network->vertex_count; v++) {
+        if (in_dense(network, v)) {
+            first[v + 1] += dense_count;
+        }
+
+        first[v + 1] += first[v];
+    }
+
+    /* parent[] doubles as the fill cursor of every vertex */
+    arc_t *fill = network->parent;
+
+    for (vertex_t v = 0; v < network->vertex_count; v++) {
+        fill[v] = first[v] + (in_dense(network, v) ? dense_count : 0);
+    }
+
+    memset(network->dense_claimed, 0, claimed_size);
+
+    for (edge_t e = 0; e < network->edge_count; e++) {
+        struct edge *edge = &network->edges[e];
+
+        arc_t forward = claim_dense(network, edge->tail, edge->head)
+            ? first[edge->tail] + edge->head - network->dense_first
+            : fill[edge->tail]++;
+        arc_t backward = claim_dense(network, edge->head, edge->tail)
+            ? first[edge->head] + edge->tail - network->dense_first
+            : fill[edge->head]++;
+
+        network->arc_head[forward] = edge->head;
+        network->arc_cost[forward] = edge->cost;
+        network->arc_residual[forward] = edge->capacity;
+        network->arc_reverse[forward] = backward;
+
+        network->arc_head[backward] = edge->tail;
+        network->arc_cost[backward] = -edge->cost;
+        network->arc_residual[backward] = 0;
+        network->arc_reverse[backward] = forward;
+
+        network->edge_arc[e] = forward;
+    }
+
+    /* dead arcs in the slots left over, their own reverse */
+    for (vertex_t k = 0; k < dense_count; k++) {
+        for (vertex_t j = 0; j < dense_count; j++) {
+            if (BITMASK_HAS(network->dense_claimed, (size_t) k * dense_count + j)) {
+                continue;
+            }
+
+            arc_t arc = first[network->dense_first + k] + j;
+
+            network->arc_head[arc] = network->dense_first + j;
+            network->arc_cost[arc] = 0;
+            network->arc_residual[arc] = 0;
+            network->arc_reverse[arc] = arc;
+        }
+    }
+}
+
+/*
+ * A copy of a laid out network with arrays of its own, flow and potentials
+ * included, for another thread to solve on. Counters start from zero.
+ */
+static inline void
+network_clone(struct network *clone, const struct network *network,
+              struct arena *arena)
+{
+    const vertex_t vertex_count = network->vertex_count;
+    const edge_t edge_count = network->edge_count;
+    const arc_t arc_count = network->first[vertex_count];
+    const size_t dense_slots = (size_t) network->dense_count * network->dense_count;
+
+    network_init(clone, arena, vertex_count, edge_count,
+                 network->dense_first, network->dense_count);
+
+    clone->edge_count = edge_count;
+    clone->source = network->source;
+    clone->sink = network->sink;
+    clone->engine = network->engine;
+    clone->total_cost = network->total_cost;
+    clone->total_flow = network->total_flow;
+
+    memcpy(clone->dense_claimed, network->dense_claimed,
+           sizeof(bitmask_t) * BITMASK_LEN(dense_slots));
+    memcpy(clone->edges, network->edges, sizeof(struct edge) * edge_count);
+    memcpy(clone->first, network->first, sizeof(arc_t) * (vertex_count + 1));
+    memcpy(clone->arc_head, network->arc_head, sizeof(vertex_t) * arc_count);
+    memcpy(clone->arc_cost, network->arc_cost, sizeof(cost_t) * arc_count);
+    memcpy(clone->arc_residual, network->arc_residual, sizeof(unit_t) * arc_count);
+    memcpy(clone->arc_reverse, network->arc_reverse, sizeof(arc_t) * arc_count);
+    memcpy(clone->edge_arc, network->edge_arc, sizeof(arc_t) * edge_count);
+    memcpy(clone->potential, network->potential, sizeof(cost_t) * vertex_count);
+    memcpy(clone->stale, network->stale,
+           sizeof(bitmask_t) * BITMASK_LEN(vertex_count));
+    clone->potential_valid = network->potential_valid;
+}
+
+/*
+ * Lowers the capacity of an edge by one unit. The residual network has no
+ * negative cycles on entry and on exit. If the edge was saturated the unit
+ * it no longer carries is rerouted along a shortest residual path, or when
+ * there is none handed back to the source so that the flow value drops.
+ */
+static inline void
+lower_capacity(struct network *network, edge_t edge)
+{
+    arc_t arc = network->edge_arc[edge];
+    arc_t reverse = network->arc_reverse[arc];
+
+    vertex_t tail = network->arc_head[reverse];
+    vertex_t head = network->arc_head[arc];
+
+    if (network->arc_residual[arc] > 0) {
+        network->arc_residual[arc]--;
+        return;
+    }
+
+    network->arc_residual[reverse]--;
+    network->total_cost -= network->arc_cost[arc];
+
+    bellman_ford_from(network, tail, head);
+    if (network->parent[head] != NO_ARC) {
+        augment(network, tail, head, 1);
+        return;
+    }
+
+    bellman_ford_from(network, tail, network->source);
+    augment(network, tail, network->source, 1);
+
+    if (head != network->sink) {
+        bellman_ford_from(network, network->sink, head);
+        augment(network, network->sink, head, 1);
+    }
+
+    network->total_flow--;
+}
+
+/*
+ * Raises the capacity of `count` edges sharing one head by one unit each.
+ * A new unit of a saturated edge closes residual cycles head -> tail -> head,
+ * so the cheapest negative one is cancelled until none is left. Candidates
+ * stay at their old capacity while searching so the search never runs into a
+ * negative cycle itself. The `edges` array is reordered.
+ */
+static inline void
+raise_capacities(struct network *network, edge_t *edges, edge_t count)
+{
+    edge_t pending = 0;
+
+    for (edge_t e = 0; e < count; e++) {
+        arc_t arc = network->edge_arc[edges[e]];
+
+        if (network->arc_residual[arc] > 0) {
+            network->arc_residual[arc]++;
+        } else {
+            edges[pending++] = edges[e];
+        }
+    }
+
+    while (pending > 0) {
+        vertex_t head = network->arc_head[network->edge_arc[edges[0]]];
+        edge_t best = -1;
+        cost_t best_cost = 0;
+
+        bellman_ford_from(network, head, head);
+
+        for (edge_t e = 0; e < pending; e++) {
+            arc_t arc = network->edge_arc[edges[e]];
+            cost_t dist = network->dist[arc_tail(network, arc)];
+
+            if (dist != COST_MAX && dist + network->arc_cost[arc] < best_cost) {
+                best = e;
+                best_cost = dist + network->arc_cost[arc];
+            }
+        }
+
+        if (best == -1) {
+            break;
+        }
+
+        arc_t arc = network->edge_arc[edges[best]];
+        edges[best] = edges[--pending];
+
+        augment(network, head, arc_tail(network, arc), 1);
+
+        network->arc_residual[network->arc_reverse[arc]]++;
+        BITMASK_SET(network->stale, head);
+        network->total_cost += network->arc_cost[arc];
+    }
+
+    for (edge_t e = 0; e < pending; e++) {
+        arc_t arc = network->edge_arc[edges[e]];
+
+        network->arc_residual[arc]++;
+        BITMASK_SET(network->stale, arc_tail(network, arc));
+    }
+}
+
+/*
+ * Changes the cost of an edge. The residual network has no negative cycles on
+ * entry and on exit: the arc of the edge that got cheaper, forward or
+ * reverse, may now close one with a shortest residual path back, the
+ * cheapest is cancelled until none is left. It stays closed while searching
+ * so that the search never runs into the cycle itself.
+ */
+static inline void
+set_edge_cost(struct network *network, edge_t edge, cost_t cost)
+{
+    arc_t arc = network->edge_arc[edge];
+    arc_t reverse = network->arc_reverse[arc];
+    const cost_t old_cost = network->edges[edge].cost;
+
+    if (cost == old_cost) {
+        return;
+    }
+
+    network->edges[edge].cost = cost;
+    network->arc_cost[arc] = cost;
+    network->arc_cost[reverse] = -cost;
+    network->total_cost += (cost - old_cost) * edge_flow(network, edge);
+
+    arc_t cheaper = cost < old_cost ? arc : reverse;
+    vertex_t tail = arc_tail(network, cheaper);
+    vertex_t head = network->arc_head[cheaper];
+
+    BITMASK_SET(network->stale, tail);
+    BITMASK_SET(network->stale, head);
+
+    while (network->arc_residual[cheaper] > 0) {
+        unit_t residual = network->arc_residual[cheaper];
+
+        network->arc_residual[cheaper] = 0;
+        bellman_ford_from(network, head, tail);
+        network->arc_residual[cheaper] = residual;
+
+        if (network->parent[tail] == NO_ARC
+                || network->dist[tail] + network->arc_cost[cheaper] >= 0) {
+            break;
+        }
+
+        unit_t flow = min(residual, network->avail[tail]);
+
+        augment(network, head, tail, flow);
+
+        network->arc_residual[cheaper] -= flow;
+        network->arc_residual[network->arc_reverse[cheaper]] += flow;
+        network->total_cost += (cost_t) flow * network->arc_cost[cheaper];
+    }
+}
+
+#endif /* MCF_INSTANCE */
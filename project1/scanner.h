@@ -0,0 +1,234 @@
+#ifndef SCANNER_H
+#define SCANNER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "arena.h"
+
+/* stdin that is not a file is read in blocks of this size */
+#define SCANNER_BLOCK (1 << 20)
+
+/*
+ * Integers out of text in memory, without copying it: the whole of a file
+ * mapped, the whole of a pipe read in large blocks, or a buffer someone else
+ * owns. On malformed input the scan fails with `error` set and the cursor
+ * where it stopped, the line worked out only then.
+ */
+struct scanner {
+    const char *start;
+    const char *cursor;
+    const char *end;
+
+    const char *error;
+
+    /* what scanner_close() gives back, at most one of the two */
+    void *mapping;
+    size_t mapped;
+    char *buffer;
+};
+
+static inline void
+scanner_open_memory(struct scanner *scanner, const char *text, size_t length)
+{
+    *scanner = (struct scanner) {
+        .start = text,
+        .cursor = text,
+        .end = text + length,
+    };
+}
+
+/* maps `fd` if it is a regular file and reads it to the end otherwise */
+static inline bool
+scanner_open_fd(struct scanner *scanner, int fd)
+{
+    struct stat st;
+
+    scanner_open_memory(scanner, NULL, 0);
+
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (mapping != MAP_FAILED) {
+            madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+
+            scanner_open_memory(scanner, mapping, st.st_size);
+            scanner->mapping = mapping;
+            scanner->mapped = st.st_size;
+            return true;
+        }
+    }
+
+    size_t capacity = SCANNER_BLOCK;
+    size_t length = 0;
+    char *buffer = valloc(capacity);
+
+    for (;;) {
+        if (capacity - length < SCANNER_BLOCK) {
+            capacity *= 2;
+            buffer = realloc(buffer, capacity);
+        }
+
+        ssize_t got = read(fd, buffer + length, capacity - length);
+
+        if (got == 0) {
+            break;
+        }
+
+        if (got < 0) {
+            free(buffer);
+            return false;
+        }
+
+        length += got;
+    }
+
+    scanner_open_memory(scanner, buffer, length);
+    scanner->buffer = buffer;
+    return true;
+}
+
+static inline void
+scanner_close(struct scanner *scanner)
+{
+    if (scanner->mapping != NULL) {
+        munmap(scanner->mapping, scanner->mapped);
+    }
+
+    free(scanner->buffer);
+    scanner_open_memory(scanner, NULL, 0);
+}
+
+static inline bool
+scanner_fail(struct scanner *scanner, const char *error)
+{
+    scanner->error = error;
+    return false;
+}
+
+static inline size_t
+scanner_left(const struct scanner *scanner)
+{
+    return scanner->end - scanner->cursor;
+}
+
+/* the line of the cursor, counted from 1 */
+static inline int
+scanner_line(const struct scanner *scanner)
+{
+    const char *at = scanner->start;
+    int line = 1;
+
+    while ((at = memchr(at, '\n', scanner->cursor - at)) != NULL) {
+        at++;
+        line++;
+    }
+
+    return line;
+}
+
+static inline bool
+scanner_space(char c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/* the next run of anything but white space, into `word` of `size` bytes */
+static inline bool
+scanner_word(struct scanner *scanner, char *word, size_t size)
+{
+    const char *at = scanner->cursor;
+    const char *end = scanner->end;
+
+    while (at < end && scanner_space(*at)) {
+        at++;
+    }
+
+    scanner->cursor = at;
+
+    const char *first = at;
+    while (at < end && !scanner_space(*at)) {
+        at++;
+    }
+
+    if (at == first) {
+        return scanner_fail(scanner, "unexpected end of input");
+    }
+
+    if ((size_t) (at - first) >= size) {
+        return scanner_fail(scanner, "word too long");
+    }
+
+    memcpy(word, first, at - first);
+    word[at - first] = '\0';
+
+    scanner->cursor = at;
+    return true;
+}
+
+/* nothing but white space left */
+static inline bool
+scanner_finish(struct scanner *scanner)
+{
+    while (scanner->cursor < scanner->end && scanner_space(*scanner->cursor)) {
+        scanner->cursor++;
+    }
+
+    if (scanner->cursor < scanner->end) {
+        return scanner_fail(scanner, "unexpected input after the end");
+    }
+
+    return true;
+}
+
+/* the next integer, after any white space, optionally signed */
+static inline bool
+scanner_int32(struct scanner *scanner, int32_t *value)
+{
+    const char *at = scanner->cursor;
+    const char *end = scanner->end;
+
+    while (at < end && scanner_space(*at)) {
+        at++;
+    }
+
+    scanner->cursor = at;
+
+    bool negative = at < end && *at == '-';
+    if (at < end && (*at == '-' || *at == '+')) {
+        at++;
+    }
+
+    if (at == end || (unsigned) (*at - '0') > 9) {
+        return scanner_fail(scanner, at == end ? "unexpected end of input"
+                                               : "expected an integer");
+    }
+
+    /* one past INT32_MAX is allowed in while reading, for INT32_MIN */
+    const int64_t bound = (int64_t) INT32_MAX + negative;
+    int64_t magnitude = 0;
+
+    for (; at < end && (unsigned) (*at - '0') <= 9; at++) {
+        magnitude = magnitude * 10 + (*at - '0');
+
+        if (magnitude > bound) {
+            return scanner_fail(scanner, "integer out of range");
+        }
+    }
+
+    if (at < end && !scanner_space(*at)) {
+        return scanner_fail(scanner, "expected an integer");
+    }
+
+    *value = negative ? -magnitude : magnitude;
+    scanner->cursor = at;
+    return true;
+}
+
+#endif /* SCANNER_H */
@@ -0,0 +1,460 @@
+/*
+ * Long running mode, answering cases for as long as clients send them. A
+ * request is one case of the batch format, length prefixed:
+ *
+ *     <length>\n
+ *     <budget> <players>\n
+ *     <player a> <player b> <winner> <bribe>\n ...
+ *
+ * with <length> the bytes from the budget on. It gets one line back, "TAK
+ * <usec>" or "NIE <usec>", usec from having the request to having its
+ * answer, or "ERR <reason>". A request may also be a what-if command, see
+ * serve_what_if(). With a socket path every client connection gets a thread,
+ * with "-" stdin and stdout are the one connection.
+ *
+ * The -j solvers outlive the requests, a request takes one and hands it back
+ * after. Their arenas grown for one case are there for the next, whoever
+ * sends it, and no more than -j cases are solved at once. What-if sessions
+ * do not use them: a session is built in an arena of its own that lives as
+ * long as its connection, and only -j session commands run at once.
+ */
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "solver.h"
+
+/* larger requests are refused unread, the connection closed */
+#define MAX_REQUEST_BYTES (256 << 20)
+
+struct server {
+    const struct options *options;
+
+    pthread_mutex_t lock;
+    pthread_cond_t handed_back;
+
+    struct solver *solvers;
+    struct solver **idle;
+    int idle_count;
+
+    /* what-if commands that may start, of -j */
+    int session_slots;
+    pthread_cond_t session_done;
+
+    _Atomic int next_index;
+};
+
+struct connection {
+    struct server *server;
+
+    FILE *in;
+    FILE *out;
+
+    /* grown to the largest request seen on the connection */
+    char *request;
+    size_t capacity;
+    struct arena input_arena;
+
+    /* the case kept solved for what-if commands, if one was opened */
+    struct what_if *what_if;
+};
+
+static struct solver *
+server_take(struct server *server)
+{
+    pthread_mutex_lock(&server->lock);
+
+    while (server->idle_count == 0) {
+        pthread_cond_wait(&server->handed_back, &server->lock);
+    }
+
+    struct solver *solver = server->idle[--server->idle_count];
+
+    pthread_mutex_unlock(&server->lock);
+    return solver;
+}
+
+static void
+server_hand_back(struct server *server, struct solver *solver)
+{
+    pthread_mutex_lock(&server->lock);
+
+    server->idle[server->idle_count++] = solver;
+    pthread_cond_signal(&server->handed_back);
+
+    pthread_mutex_unlock(&server->lock);
+}
+
+static void
+session_enter(struct server *server)
+{
+    pthread_mutex_lock(&server->lock);
+
+    while (server->session_slots == 0) {
+        pthread_cond_wait(&server->session_done, &server->lock);
+    }
+
+    server->session_slots--;
+
+    pthread_mutex_unlock(&server->lock);
+}
+
+static void
+session_leave(struct server *server)
+{
+    pthread_mutex_lock(&server->lock);
+
+    server->session_slots++;
+    pthread_cond_signal(&server->session_done);
+
+    pthread_mutex_unlock(&server->lock);
+}
+
+static void
+answer(struct connection *connection, const char *line)
+{
+    fputs(line, connection->out);
+    fflush(connection->out);
+}
+
+static void
+answer_found(struct connection *connection, bool found, int64_t started)
+{
+    char line[64];
+
+    snprintf(line, sizeof(line), "%s %lld\n", found ? "TAK" : "NIE",
+             (long long) (now_usec() - started));
+    answer(connection, line);
+}
+
+/*
+ * Reads the case of `length` bytes at `text` into `input`, in place. When it
+ * is malformed the client is told why.
+ */
+static bool
+read_request_case(struct connection *connection, const char *text, size_t length,
+                  struct tournament_input *input)
+{
+    struct scanner scanner;
+    char line[160];
+
+    arena_reset(&connection->input_arena);
+    scanner_open_memory(&scanner, text, length);
+
+    if (read_tournament(&scanner, input, &connection->input_arena)) {
+        return true;
+    }
+
+    snprintf(line, sizeof(line), "ERR malformed case, line %d: %s\n",
+             scanner_line(&scanner), scanner.error);
+    answer(connection, line);
+    return false;
+}
+
+/*
+ * A what-if command instead of a case. "open" with a case on the lines after
+ * keeps that case solved on the connection, "bribe <game> <bribe>", "flip
+ * <game>" and "budget <budget>" edit the case kept, games numbered from 0 in
+ * the order of the case. Every command is answered like a case, one with
+ * numbers out of range or anything after them with ERR.
+ */
+static void
+serve_what_if(struct connection *connection, size_t length)
+{
+    struct server *server = connection->server;
+    const int64_t started = now_usec();
+    struct scanner scanner;
+    char command[16];
+    char line[160];
+    int32_t game_idx, value;
+
+    scanner_open_memory(&scanner, connection->request, length);
+
+    if (!scanner_word(&scanner, command, sizeof(command))) {
+        snprintf(line, sizeof(line), "ERR malformed command: %s\n", scanner.error);
+        answer(connection, line);
+        return;
+    }
+
+    if (strcmp(command, "open") == 0) {
+        struct tournament_input input = {
+            .index = atomic_fetch_add(&server->next_index, 1),
+        };
+
+        if (!read_request_case(connection, scanner.cursor, scanner_left(&scanner),
+                               &input)) {
+            return;
+        }
+
+        session_enter(server);
+
+        if (connection->what_if != NULL) {
+            what_if_close(connection->what_if);
+        }
+        connection->what_if = what_if_open(server->options, &input);
+
+        session_leave(server);
+
+        answer_found(connection, what_if_answer(connection->what_if), started);
+        return;
+    }
+
+    bool parsed;
+
+    if (strcmp(command, "bribe") == 0) {
+        parsed = scanner_int32(&scanner, &game_idx) && scanner_int32(&scanner, &value);
+    } else if (strcmp(command, "flip") == 0) {
+        parsed = scanner_int32(&scanner, &game_idx);
+    } else if (strcmp(command, "budget") == 0) {
+        parsed = scanner_int32(&scanner, &value);
+    } else {
+        parsed = scanner_fail(&scanner, "unknown command");
+    }
+
+    if (!parsed || !scanner_finish(&scanner)) {
+        snprintf(line, sizeof(line), "ERR malformed command: %s\n", scanner.error);
+        answer(connection, line);
+        return;
+    }
+
+    if (connection->what_if == NULL) {
+        answer(connection, "ERR no case open\n");
+        return;
+    }
+
+    bool known = true;
+
+    session_enter(server);
+
+    if (strcmp(command, "bribe") == 0) {
+        known = what_if_set_bribe(connection->what_if, game_idx, value);
+    } else if (strcmp(command, "flip") == 0) {
+        known = what_if_flip(connection->what_if, game_idx);
+    } else {
+        what_if_set_budget(connection->what_if, value);
+    }
+
+    session_leave(server);
+
+    if (!known) {
+        answer(connection, "ERR no such game\n");
+    } else {
+        answer_found(connection, what_if_answer(connection->what_if), started);
+    }
+}
+
+/* solves the case, or carries out the command, of `length` bytes */
+static void
+serve_request(struct connection *connection, size_t length)
+{
+    struct server *server = connection->server;
+    const int64_t started = now_usec();
+
+    connection->request[length] = '\0';
+
+    if (islower((unsigned char) connection->request[0])) {
+        serve_what_if(connection, length);
+        return;
+    }
+
+    struct tournament_input input = {
+        .index = atomic_fetch_add(&server->next_index, 1),
+    };
+
+    if (!read_request_case(connection, connection->request, length, &input)) {
+        return;
+    }
+
+    struct solver *solver = server_take(server);
+    bool found = solve_tournament(solver, &input);
+    server_hand_back(server, solver);
+
+    answer_found(connection, found, started);
+}
+
+/* until the client hangs up, or sends a length that loses the framing */
+static void
+serve_connection(struct connection *connection)
+{
+    char line[32];
+
+    while (fgets(line, sizeof(line), connection->in) != NULL) {
+        char *end;
+        long long length = strtoll(line, &end, 10);
+
+        if (end == line || *end != '\n' || length <= 0 || length > MAX_REQUEST_BYTES) {
+            answer(connection, "ERR bad length\n");
+            return;
+        }
+
+        if ((size_t) length + 1 > connection->capacity) {
+            free(connection->request);
+
+            connection->capacity = max((size_t) length + 1, 2 * connection->capacity);
+            connection->request = valloc(connection->capacity);
+        }
+
+        if (fread(connection->request, 1, length, connection->in) != (size_t) length) {
+            return;
+        }
+
+        serve_request(connection, length);
+    }
+}
+
+static void
+connection_release(struct connection *connection)
+{
+    if (connection->what_if != NULL) {
+        what_if_close(connection->what_if);
+    }
+
+    free(connection->request);
+    arena_release(&connection->input_arena);
+}
+
+static void *
+connection_main(void *arg)
+{
+    struct connection *connection = arg;
+
+    serve_connection(connection);
+
+    fclose(connection->in);
+    fclose(connection->out);
+
+    connection_release(connection);
+    free(connection);
+
+    return NULL;
+}
+
+static int
+serve_socket(struct server *server, const char *path)
+{
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "%s: socket path too long\n", path);
+        return 1;
+    }
+
+    strcpy(address.sun_path, path);
+    unlink(path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (listener < 0
+            || bind(listener, (struct sockaddr *) &address, sizeof(address)) != 0
+            || listen(listener, SOMAXCONN) != 0) {
+        perror(path);
+        return 1;
+    }
+
+    for (;;) {
+        int fd = accept(listener, NULL, NULL);
+
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+
+            perror("accept");
+            break;
+        }
+
+        struct connection *connection = valloc(sizeof(struct connection));
+        *connection = (struct connection) {
+            .server = server,
+            .in = fdopen(fd, "r"),
+            .out = fdopen(dup(fd), "w"),
+        };
+
+        pthread_t thread;
+
+        if (connection->in == NULL || connection->out == NULL
+                || pthread_create(&thread, NULL, connection_main, connection) != 0) {
+            perror("connection");
+
+            if (connection->in != NULL) {
+                fclose(connection->in);
+            } else {
+                close(fd);
+            }
+            if (connection->out != NULL) {
+                fclose(connection->out);
+            }
+
+            free(connection);
+            continue;
+        }
+
+        pthread_detach(thread);
+    }
+
+    close(listener);
+    return 1;
+}
+
+int
+serve(const struct options *options)
+{
+    const int solver_count = options->jobs;
+    int status = 0;
+
+    struct server server = {
+        .options = options,
+        .solvers = valloc(sizeof(struct solver) * solver_count),
+        .idle = valloc(sizeof(struct solver *) * solver_count),
+        .idle_count = solver_count,
+        .session_slots = solver_count,
+    };
+
+    pthread_mutex_init(&server.lock, NULL);
+    pthread_cond_init(&server.handed_back, NULL);
+    pthread_cond_init(&server.session_done, NULL);
+    atomic_init(&server.next_index, 0);
+
+    for (int s = 0; s < solver_count; s++) {
+        server.solvers[s] = (struct solver) { .options = options };
+        server.idle[s] = &server.solvers[s];
+    }
+
+    /* a client hanging up before its answer is not the server's problem */
+    signal(SIGPIPE, SIG_IGN);
+
+    if (strcmp(options->serve, "-") == 0) {
+        struct connection connection = {
+            .server = &server,
+            .in = stdin,
+            .out = stdout,
+        };
+
+        serve_connection(&connection);
+        connection_release(&connection);
+    } else {
+        status = serve_socket(&server, options->serve);
+    }
+
+    for (int s = 0; s < solver_count; s++) {
+        arena_release(&server.solvers[s].arena);
+    }
+
+    pthread_cond_destroy(&server.handed_back);
+    pthread_cond_destroy(&server.session_done);
+    pthread_mutex_destroy(&server.lock);
+    free(server.solvers);
+    free(server.idle);
+
+    return status;
+}
@@ -0,0 +1,138 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#if 1
+#undef DDEEBBUUGG
+#endif
+
+#ifdef DDEEBBUUGG
+extern FILE *dot_file;
+#define dotdebug(...) fprintf(dot_file, __VA_ARGS__)
+#define dprintf(...) printf(__VA_ARGS__)
+#else
+#define dotdebug(...)
+#define dprintf(...)
+#endif
+
+#include "arena.h"
+#include "mcf.h"
+#include "scanner.h"
+
+typedef int32_t player_idx_t;
+
+/* the most players whose games are still counted in 32 bits */
+#define MAX_PLAYERS 46340
+
+/* the shortest a game can be, "\n0 1 0 0" with the white space before it */
+#define MIN_GAME_BYTES 8
+
+enum search {
+    SEARCH_LINEAR,
+    SEARCH_BINARY,
+};
+
+enum stats {
+    STATS_NONE,
+    STATS_JSON,
+    STATS_CSV,
+};
+
+/* auto takes the narrow engine for every case it holds */
+enum width {
+    WIDTH_AUTO,
+    WIDTH_WIDE,
+};
+
+/* auto lays the players out dense from DENSE_MIN_PLAYERS on */
+enum layout {
+    LAYOUT_AUTO,
+    LAYOUT_SPARSE,
+    LAYOUT_DENSE,
+};
+
+#define DENSE_MIN_PLAYERS 32
+
+/* smaller cases are solved before threads to speculate on would be running */
+#define SPECULATE_MIN_PLAYERS 64
+
+struct options {
+    enum engine engine;
+    enum search search;
+    bool warm_start;
+    bool prune;
+    enum layout layout;
+    bool verbose;
+    int jobs;
+    int speculate; /* threads on the limits of one case, 1 for none */
+    enum stats stats;
+    enum width width;
+
+    /* with a socket path, or "-" for stdin, serve requests instead of a batch */
+    const char *serve;
+};
+
+struct game {
+    player_idx_t winner;
+    player_idx_t loser;
+    int32_t bribe;
+};
+
+/* one test case as read, player_count * (player_count - 1) / 2 games */
+struct tournament_input {
+    int index;
+    int32_t budget;
+    player_idx_t player_count;
+
+    struct game *games;
+
+    /* spent scanning the case, loading the input not included */
+    int64_t read_usec;
+};
+
+/* per thread state reused from one test case to the next */
+struct solver {
+    const struct options *options;
+
+    struct arena arena;
+};
+
+bool read_tournament(struct scanner *scanner, struct tournament_input *input,
+                     struct arena *arena);
+
+/* the narrow engine when it holds the case, the wide one otherwise */
+bool solve_tournament(struct solver *solver, const struct tournament_input *input);
+
+void print_stats(enum stats stats, const struct tournament_input *input,
+                 const struct counters *counters, int64_t total_usec, bool found);
+
+/* tournament.h instantiated with 16 bit vertices and units, 32 bit costs */
+bool solve_tournament_narrow(struct solver *solver,
+                             const struct tournament_input *input);
+
+/* tournament.h instantiated with 32 bit vertices and units, 64 bit costs */
+bool solve_tournament_wide(struct solver *solver,
+                           const struct tournament_input *input);
+
+/*
+ * what_if.h, one case kept solved across edits, games numbered in the order
+ * read. An edit answers the edited case; it returns false, changing nothing,
+ * for a game out of range.
+ */
+struct what_if;
+
+struct what_if *what_if_open(const struct options *options,
+                             const struct tournament_input *input);
+bool what_if_answer(const struct what_if *what_if);
+bool what_if_set_bribe(struct what_if *what_if, int32_t game_idx, int32_t bribe);
+bool what_if_flip(struct what_if *what_if, int32_t game_idx);
+void what_if_set_budget(struct what_if *what_if, int32_t budget);
+void what_if_close(struct what_if *what_if);
+
+/* server.c, runs until killed, returns non-zero if it cannot start */
+int serve(const struct options *options);
+
+#endif /* SOLVER_H */
@@ -0,0 +1,1105 @@
+/*
+ * Tournament driver over the min-cost flow engine, instantiated like mcf.h:
+ * define MCF_VERTEX_T, MCF_UNIT_T, MCF_COST_T and SOLVE_TOURNAMENT, the name
+ * the entry point gets, then include this file once.
+ */
+#include <pthread.h>
+
+#include "solver.h"
+#include "mcf.h"
+
+struct tournament {
+    player_idx_t player_count; /* in the network */
+    edge_t game_count; /* as read */
+    cost_t budget;
+    unit_t max_points;
+
+    /* routed through the network, one per game less those of fixed players */
+    unit_t point_count;
+
+    /* indexed by player as read, the vertex is 0 for a player fixed up front */
+    unit_t *wins;
+    vertex_t *player_vertex;
+    bool *kept; /* per game, whether its arc made it into the network */
+
+    /*
+     * bribes within budget of the games every player won, ascending and
+     * summed up, shed[shed_first[p]] .. shed[shed_first[p + 1] - 1]; priced
+     * when none of them is negative
+     */
+    edge_t *shed_first;
+    int64_t *shed;
+    bool priced;
+
+    /* more than any flow can cost, one missing unit of flow weighs this much */
+    int64_t deficit_cost;
+    bool timed;
+
+    /* keep the flow of `solved_limit` when moving on to the next limit */
+    bool warm_start;
+    unit_t solved_limit;
+    edge_t *raised;
+
+    /*
+     * limits outside [first_limit, last_limit] were ruled out up front, with
+     * `prune` the others are checked by a cost oblivious max flow first
+     */
+    bool prune;
+    unit_t first_limit;
+    unit_t last_limit;
+
+    struct network *network;
+
+    edge_t *source_player;
+    edge_t *player_limit;
+    edge_t limit_sink;
+};
+
+/* moves the optimal flow for `limit - 1` over to `limit` */
+static void
+warm_limit(struct tournament *tournament)
+{
+    struct network *network = tournament->network;
+    edge_t raised = 0;
+
+    lower_capacity(network, tournament->limit_sink);
+
+    raise_capacities(network, &tournament->player_limit[0], 1);
+
+    for (player_idx_t player_idx = 1; player_idx < tournament->player_count;
+            player_idx++) {
+        tournament->raised[raised++] = tournament->player_limit[player_idx];
+    }
+
+    raise_capacities(network, tournament->raised, raised);
+}
+
+/*
+ * Sets the capacities for `limit` and a flow of minimum cost to start from:
+ * every player sends as much of its points as the limit lets through its own
+ * arc, no game arc carries flow.
+ */
+static void
+seed_limit(struct tournament *tournament, unit_t limit)
+{
+    struct network *network = tournament->network;
+    const unit_t limit_capacity = tournament->point_count - limit;
+    unit_t limit_flow = 0;
+
+    network->total_cost = 0;
+    network->total_flow = 0;
+
+    for (edge_t e = 0; e < network->edge_count; e++) {
+        edge_set(network, e, edge_capacity(network, e), 0);
+    }
+
+    for (player_idx_t player_idx = 0; player_idx < tournament->player_count;
+            player_idx++) {
+        edge_t source_player = tournament->source_player[player_idx];
+        unit_t points = edge_capacity(network, source_player);
+
+        unit_t flow = min(points, limit);
+        flow = min(flow, limit_capacity - limit_flow);
+
+        if (player_idx != 0) {
+            limit_flow += flow;
+        }
+
+        edge_set(network, source_player, points, flow);
+        edge_set(network, tournament->player_limit[player_idx], limit, flow);
+
+        network->total_flow += flow;
+    }
+
+    edge_set(network, tournament->limit_sink, limit_capacity, limit_flow);
+}
+
+/*
+ * Solves min-cost max-flow with player 0 finishing at exactly `limit` points
+ * and everybody else at most `limit`. The returned penalty orders outcomes by
+ * missing flow first and cost second; as the optimum of a linear program
+ * whose capacities are affine in `limit` it is convex in `limit`. With `cut`
+ * the solve stops once it is bound to go over budget, the penalty is then
+ * meaningless.
+ */
+static bool
+try_limit(struct tournament *tournament, unit_t limit, bool cut, int64_t *penalty)
+{
+    struct network *network = tournament->network;
+    const unit_t point_count = tournament->point_count;
+
+    dprintf("\n");
+    dprintf("limit = %lld\n", limit);
+
+    int64_t started = tournament->timed ? now_usec() : 0;
+
+    if (tournament->warm_start && tournament->solved_limit == limit - 1) {
+        warm_limit(tournament);
+        network->counters.warm_starts++;
+
+        if (tournament->timed) {
+            network->counters.warm_usec += now_usec() - started;
+            started = now_usec();
+        }
+    } else {
+        seed_limit(tournament, limit);
+    }
+
+    network->cost_limit = cut ? tournament->budget : COST_MAX;
+    network->cut_short = false;
+
+    maxflow(network);
+    network->counters.limits++;
+    network->counters.cut_short += network->cut_short;
+    tournament->solved_limit = limit;
+
+    if (tournament->timed) {
+        network->counters.flow_usec += now_usec() - started;
+    }
+
+    dprintf("spent = %lld\n", network->total_cost);
+    dprintf("total_flow = %d %d\n", network->total_flow, point_count);
+
+    *penalty = (int64_t) (point_count - network->total_flow) * tournament->deficit_cost
+        + network->total_cost;
+
+    return network->total_cost <= tournament->budget
+        && network->total_flow == point_count;
+}
+
+/*
+ * The flow missing at `limit` by a cost oblivious max flow, far cheaper than
+ * the min-cost one. Like the penalty it is convex in `limit`. The flow left
+ * behind is not of minimum cost, so it cannot be warm started from.
+ */
+static unit_t
+limit_deficit(struct tournament *tournament, unit_t limit)
+{
+    struct network *network = tournament->network;
+    int64_t started = tournament->timed ? now_usec() : 0;
+
+    seed_limit(tournament, limit);
+    dinic(network);
+
+    network->counters.flow_checks++;
+    tournament->solved_limit = UNIT_MIN;
+
+    if (tournament->timed) {
+        network->counters.flow_usec += now_usec() - started;
+    }
+
+    return tournament->point_count - network->total_flow;
+}
+
+/*
+ * Ascending, so with pruning the missing flow falls to zero, stays there for
+ * a while and rises again. Limits up to the first without missing flow only
+ * get the max flow check.
+ */
+static bool
+search_linear(struct tournament *tournament)
+{
+    struct network *network = tournament->network;
+    unit_t last_deficit = UNIT_MAX;
+    bool flowing = !tournament->prune;
+    int64_t penalty;
+
+    for (unit_t limit = tournament->first_limit;
+            limit <= tournament->last_limit; limit++) {
+        if (!flowing) {
+            unit_t deficit = limit_deficit(tournament, limit);
+
+            if (deficit > 0) {
+                network->counters.flow_rejects++;
+
+                /* convex, once it stops falling it never gets to zero */
+                if (deficit >= last_deficit) {
+                    return false;
+                }
+
+                last_deficit = deficit;
+                continue;
+            }
+
+            flowing = true;
+        }
+
+        if (try_limit(tournament, limit, tournament->prune, &penalty)) {
+            return true;
+        }
+
+        if (tournament->prune && !network->cut_short
+                && network->total_flow < tournament->point_count) {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Penalties of `limit` and `limit + 1`. With pruning the missing flow of both
+ * is found by max flow first and min-cost flow only runs where none is
+ * missing; a penalty of a limit missing flow then leaves out the cost, which
+ * does not change how penalties compare. Returns whether either is feasible.
+ */
+static bool
+probe_pair(struct tournament *tournament, unit_t limit, int64_t penalty[2])
+{
+    struct network *network = tournament->network;
+    unit_t deficit[2] = { 0, 0 };
+
+    if (tournament->prune) {
+        for (int i = 0; i < 2; i++) {
+            deficit[i] = limit_deficit(tournament, limit + i);
+            penalty[i] = (int64_t) deficit[i] * tournament->deficit_cost;
+        }
+    }
+
+    for (int i = 0; i < 2; i++) {
+        if (deficit[i] > 0) {
+            network->counters.flow_rejects++;
+        } else if (try_limit(tournament, limit + i, false, &penalty[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * The penalty is convex in the limit, so feasible limits form an interval
+ * around its minimum. Bisect on the sign of the forward difference.
+ */
+static bool
+search_binary(struct tournament *tournament)
+{
+    unit_t lo = tournament->first_limit;
+    unit_t hi = tournament->last_limit;
+
+    int64_t penalty[2];
+
+    if (lo >= hi) {
+        return lo == hi && try_limit(tournament, lo, tournament->prune, &penalty[0]);
+    }
+
+    while (lo < hi) {
+        unit_t mid = lo + (hi - lo) / 2;
+
+        if (probe_pair(tournament, mid, penalty)) {
+            return true;
+        }
+
+        /* flat while flow is missing, so no limit gets all of it */
+        if (tournament->prune && penalty[0] == penalty[1]
+                && penalty[0] >= tournament->deficit_cost) {
+            return false;
+        }
+
+        if (penalty[0] <= penalty[1]) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    /* the minimum was one of the limits tried in the last step */
+    return false;
+}
+
+/* one thread of search_speculative, with a network of its own */
+struct speculator {
+    struct speculation *speculation;
+
+    struct tournament tournament;
+    struct network network;
+    struct arena arena;
+
+    _Atomic bool cancel;
+
+    /* the limit probed this round, UNIT_MIN to sit it out, and the outcome */
+    unit_t limit;
+    int64_t penalty;
+
+    pthread_t thread;
+};
+
+struct speculation {
+    pthread_mutex_t lock;
+    pthread_cond_t started;
+    pthread_cond_t finished;
+
+    int round;
+    int busy; /* speculators still probing this round */
+    bool over;
+    bool found;
+
+    int speculator_count;
+    struct speculator *speculators;
+};
+
+/*
+ * Penalty of the speculator's limit as in probe_pair, leaving out the cost
+ * of a limit found missing flow by max flow. Once a limit turns out
+ * feasible every other probe of the round is cancelled.
+ */
+static void
+speculator_probe(struct speculator *speculator)
+{
+    struct speculation *speculation = speculator->speculation;
+    struct tournament *tournament = &speculator->tournament;
+    struct network *network = tournament->network;
+    const unit_t limit = speculator->limit;
+    bool feasible = false;
+
+    network->counters.speculated++;
+
+    if (tournament->prune) {
+        unit_t deficit = limit_deficit(tournament, limit);
+
+        speculator->penalty = (int64_t) deficit * tournament->deficit_cost;
+
+        if (deficit > 0) {
+            network->counters.flow_rejects++;
+        }
+    }
+
+    if (speculator->penalty == 0 && !cancelled(network)) {
+        feasible = try_limit(tournament, limit, false, &speculator->penalty);
+    }
+
+    pthread_mutex_lock(&speculation->lock);
+
+    if (cancelled(network)) {
+        network->counters.cancelled++;
+        tournament->solved_limit = UNIT_MIN;
+    } else if (feasible) {
+        speculation->found = true;
+
+        for (int s = 0; s < speculation->speculator_count; s++) {
+            atomic_store(&speculation->speculators[s].cancel, true);
+        }
+    }
+
+    pthread_mutex_unlock(&speculation->lock);
+}
+
+static void *
+speculator_main(void *arg)
+{
+    struct speculator *speculator = arg;
+    struct speculation *speculation = speculator->speculation;
+    int seen = 0;
+
+    pthread_mutex_lock(&speculation->lock);
+
+    for (;;) {
+        while (speculation->round == seen && !speculation->over) {
+            pthread_cond_wait(&speculation->started, &speculation->lock);
+        }
+
+        if (speculation->over) {
+            break;
+        }
+
+        seen = speculation->round;
+
+        if (speculator->limit != UNIT_MIN) {
+            pthread_mutex_unlock(&speculation->lock);
+            speculator_probe(speculator);
+            pthread_mutex_lock(&speculation->lock);
+        }
+
+        if (--speculation->busy == 0) {
+            pthread_cond_signal(&speculation->finished);
+        }
+    }
+
+    pthread_mutex_unlock(&speculation->lock);
+    return NULL;
+}
+
+/* probes the limits set on the speculators, speculator 0 on this thread */
+static void
+speculation_round(struct speculation *speculation)
+{
+    pthread_mutex_lock(&speculation->lock);
+
+    for (int s = 0; s < speculation->speculator_count; s++) {
+        speculation->speculators[s].penalty = 0;
+        atomic_store(&speculation->speculators[s].cancel, false);
+    }
+
+    speculation->busy = speculation->speculator_count - 1;
+    speculation->round++;
+    pthread_cond_broadcast(&speculation->started);
+
+    pthread_mutex_unlock(&speculation->lock);
+
+    speculator_probe(&speculation->speculators[0]);
+
+    pthread_mutex_lock(&speculation->lock);
+
+    while (speculation->busy > 0) {
+        pthread_cond_wait(&speculation->finished, &speculation->lock);
+    }
+
+    pthread_mutex_unlock(&speculation->lock);
+}
+
+/*
+ * search_binary on `count` threads, each with a copy of the network made up
+ * front. Every round probes `count` limits spread over what is left at
+ * once. The penalty being convex, its minimum lies between the neighbours of
+ * the smallest penalty probed, so a round cuts the range to about
+ * 2 / (count + 1) of it where bisection halves it in two solves. The first
+ * limit found feasible answers the case and cancels the rest of its round.
+ */
+static bool
+search_speculative(struct tournament *tournament, int count)
+{
+    struct network *network = tournament->network;
+    unit_t lo = tournament->first_limit;
+    unit_t hi = tournament->last_limit;
+
+    struct speculation speculation = {
+        .speculator_count = count,
+        .speculators = valloc(sizeof(struct speculator) * count),
+    };
+
+    pthread_mutex_init(&speculation.lock, NULL);
+    pthread_cond_init(&speculation.started, NULL);
+    pthread_cond_init(&speculation.finished, NULL);
+
+    /* speculator 0 runs on the calling thread, on the network as it is */
+    for (int s = 0; s < count; s++) {
+        struct speculator *speculator = &speculation.speculators[s];
+
+        speculator->speculation = &speculation;
+        speculator->tournament = *tournament;
+        speculator->arena = (struct arena) { 0 };
+        atomic_init(&speculator->cancel, false);
+
+        if (s > 0) {
+            network_clone(&speculator->network, network, &speculator->arena);
+
+            speculator->tournament.network = &speculator->network;
+            speculator->tournament.raised = arena_alloc(&speculator->arena,
+                    sizeof(edge_t) * tournament->player_count);
+        }
+
+        speculator->tournament.network->cancel = &speculator->cancel;
+    }
+
+    for (int s = 1; s < count; s++) {
+        pthread_create(&speculation.speculators[s].thread, NULL, speculator_main,
+                       &speculation.speculators[s]);
+    }
+
+    while (lo <= hi) {
+        const int64_t span = hi - lo + 1;
+        const int probes = min(count, span);
+        struct speculator *speculators = speculation.speculators;
+
+        for (int s = 0; s < count; s++) {
+            if (s >= probes) {
+                speculators[s].limit = UNIT_MIN;
+            } else if (span <= count) {
+                speculators[s].limit = lo + s;
+            } else {
+                speculators[s].limit = lo + (s + 1) * (span + 1) / (probes + 1) - 1;
+            }
+        }
+
+        speculation_round(&speculation);
+
+        /* with every limit left probed, the smallest penalty was not feasible */
+        if (speculation.found || span <= count) {
+            break;
+        }
+
+        int best = 0;
+        for (int s = 1; s < probes; s++) {
+            if (speculators[s].penalty < speculators[best].penalty) {
+                best = s;
+            }
+        }
+
+        if (best + 1 < probes
+                && speculators[best].penalty == speculators[best + 1].penalty) {
+            lo = speculators[best].limit + 1;
+            hi = speculators[best + 1].limit - 1;
+        } else {
+            lo = best > 0 ? speculators[best - 1].limit + 1 : lo;
+            hi = best + 1 < probes ? speculators[best + 1].limit - 1 : hi;
+        }
+    }
+
+    pthread_mutex_lock(&speculation.lock);
+    speculation.over = true;
+    pthread_cond_broadcast(&speculation.started);
+    pthread_mutex_unlock(&speculation.lock);
+
+    for (int s = 1; s < count; s++) {
+        struct speculator *speculator = &speculation.speculators[s];
+
+        pthread_join(speculator->thread, NULL);
+
+        counters_add(&network->counters, &speculator->network.counters);
+        arena_release(&speculator->arena);
+    }
+
+    network->cancel = NULL;
+
+    pthread_cond_destroy(&speculation.finished);
+    pthread_cond_destroy(&speculation.started);
+    pthread_mutex_destroy(&speculation.lock);
+    free(speculation.speculators);
+
+    return speculation.found;
+}
+
+/* sum of the `count` cheapest bribes of a sorted run, INT64_MAX if too few */
+static int64_t
+cheapest(const int64_t *sums, edge_t begin, edge_t end, int64_t count)
+{
+    if (count <= 0) {
+        return 0;
+    }
+
+    if (count > end - begin) {
+        return INT64_MAX;
+    }
+
+    return sums[begin + count - 1];
+}
+
+static int
+compare_bribes(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *) a;
+    int64_t y = *(const int64_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+ * Narrows [first_limit, last_limit] before any flow is computed. At a limit
+ * every player above it sheds the surplus through games it won, one unit a
+ * game, and player 0 makes up its shortfall through games it lost. Too few
+ * bribable games means flow goes missing; with bribes not negative, the
+ * cheapest ones exceeding the budget means it goes over budget. Shedding only
+ * gets easier as the limit rises and making up only harder.
+ */
+static void
+prune_limits(struct tournament *tournament, const struct tournament_input *input,
+             struct arena *arena, struct counters *counters)
+{
+    const player_idx_t player_count = input->player_count;
+    const cost_t budget = tournament->budget;
+    const unit_t *wins = tournament->wins;
+
+    edge_t *first = arena_alloc(arena, sizeof(edge_t) * (player_count + 1));
+    int64_t *shed = arena_alloc(arena, sizeof(int64_t) * tournament->game_count);
+    int64_t *gain = arena_alloc(arena, sizeof(int64_t) * player_count);
+    edge_t gain_count = 0;
+    bool priced = true;
+
+    memset(first, 0, sizeof(edge_t) * (player_count + 1));
+
+    for (edge_t game_idx = 0; game_idx < tournament->game_count; game_idx++) {
+        const struct game *game = &input->games[game_idx];
+
+        if (game->bribe <= budget) {
+            first[game->winner + 1]++;
+        }
+    }
+
+    for (player_idx_t player_idx = 0; player_idx < player_count; player_idx++) {
+        first[player_idx + 1] += first[player_idx];
+    }
+
+    /* the gain run doubles as the fill cursor of every player */
+    edge_t *fill = (edge_t *) gain;
+    memcpy(fill, first, sizeof(edge_t) * player_count);
+
+    for (edge_t game_idx = 0; game_idx < tournament->game_count; game_idx++) {
+        const struct game *game = &input->games[game_idx];
+
+        if (game->bribe <= budget) {
+            shed[fill[game->winner]++] = game->bribe;
+            priced = priced && game->bribe >= 0;
+        }
+    }
+
+    for (edge_t game_idx = 0; game_idx < tournament->game_count; game_idx++) {
+        const struct game *game = &input->games[game_idx];
+
+        if (game->loser == 0 && game->bribe <= budget) {
+            gain[gain_count++] = game->bribe;
+        }
+    }
+
+    for (player_idx_t player_idx = 0; player_idx < player_count; player_idx++) {
+        edge_t begin = first[player_idx];
+        edge_t end = first[player_idx + 1];
+
+        qsort(&shed[begin], end - begin, sizeof(int64_t), compare_bribes);
+
+        for (edge_t e = begin + 1; e < end; e++) {
+            shed[e] += shed[e - 1];
+        }
+    }
+
+    qsort(gain, gain_count, sizeof(int64_t), compare_bribes);
+
+    for (edge_t e = 1; e < gain_count; e++) {
+        gain[e] += gain[e - 1];
+    }
+
+    unit_t lo = tournament->first_limit;
+    unit_t hi = tournament->last_limit;
+
+    for (; lo <= hi; lo++) {
+        int64_t bound = 0;
+
+        for (player_idx_t player_idx = 0;
+                player_idx < player_count && bound != INT64_MAX; player_idx++) {
+            int64_t cost = cheapest(shed, first[player_idx], first[player_idx + 1],
+                                    wins[player_idx] - lo);
+
+            bound = cost == INT64_MAX ? INT64_MAX : bound + cost;
+        }
+
+        if (bound != INT64_MAX && (!priced || bound <= budget)) {
+            break;
+        }
+    }
+
+    for (; hi >= lo; hi--) {
+        int64_t bound = cheapest(gain, 0, gain_count, hi - wins[0]);
+
+        if (bound != INT64_MAX && (!priced || bound <= budget)) {
+            break;
+        }
+    }
+
+    counters->bound_skips +=
+        (tournament->last_limit - tournament->first_limit) - (hi - lo);
+
+    tournament->first_limit = lo;
+    tournament->last_limit = hi;
+
+    tournament->shed_first = first;
+    tournament->shed = shed;
+    tournament->priced = priced;
+}
+
+/* whether a point passed to `player` is stuck there at every limit left */
+static bool
+stuck_player(const struct tournament *tournament, const edge_t *out,
+             const edge_t *in, player_idx_t player)
+{
+    return tournament->wins[player] >= tournament->last_limit
+        && out[player] == 0 && in[player] > 0;
+}
+
+/* whether `player` never has a point to pass on */
+static bool
+barren_player(const struct tournament *tournament, const edge_t *out,
+              const edge_t *in, player_idx_t player)
+{
+    return tournament->wins[player] == 0 && in[player] == 0 && out[player] > 0;
+}
+
+/*
+ * Drops the game arcs no flow within budget uses at any limit up to
+ * last_limit, after prune_limits. A game goes when
+ *
+ *  - with bribes not negative, its winner shedding it along with the cheapest
+ *    games of its own and everybody else shedding their cheapest ones is
+ *    over budget,
+ *  - its loser already has last_limit points or more and no game left to
+ *    pass a point on through,
+ *  - its winner has no points of its own and no game left to bring one.
+ *
+ * Players left without games keep the points they won. They are fixed: the
+ * limit is at least their wins and they are not part of the network. The
+ * survivors are renumbered in order, player 0 always among them.
+ */
+static void
+reduce_network(struct tournament *tournament, const struct tournament_input *input,
+               struct arena *arena, struct counters *counters)
+{
+    const player_idx_t player_count = input->player_count;
+    const edge_t game_count = tournament->game_count;
+    const unit_t last_limit = tournament->last_limit;
+    const unit_t *wins = tournament->wins;
+    const edge_t *shed_first = tournament->shed_first;
+    const int64_t *shed = tournament->shed;
+
+    edge_t *out = arena_alloc(arena, sizeof(edge_t) * player_count);
+    edge_t *in = arena_alloc(arena, sizeof(edge_t) * player_count);
+    int64_t *spent = arena_alloc(arena, sizeof(int64_t) * player_count);
+    int64_t bound = 0;
+
+    memset(out, 0, sizeof(edge_t) * player_count);
+    memset(in, 0, sizeof(edge_t) * player_count);
+
+    /* the shed bound of prune_limits at last_limit, the lowest in range */
+    for (player_idx_t player_idx = 0; player_idx < player_count; player_idx++) {
+        spent[player_idx] = cheapest(shed, shed_first[player_idx],
+                                     shed_first[player_idx + 1],
+                                     wins[player_idx] - last_limit);
+        bound += spent[player_idx];
+    }
+
+    for (edge_t game_idx = 0; game_idx < game_count; game_idx++) {
+        const struct game *game = &input->games[game_idx];
+        const player_idx_t winner = game->winner;
+
+        if (!tournament->kept[game_idx]) {
+            continue;
+        }
+
+        if (tournament->priced) {
+            int64_t surplus = wins[winner] - last_limit;
+            int64_t with = surplus <= 0 ? game->bribe
+                : max(spent[winner], cheapest(shed, shed_first[winner],
+                                              shed_first[winner + 1], surplus - 1)
+                                     + game->bribe);
+
+            if (bound - spent[winner] + with > tournament->budget) {
+                tournament->kept[game_idx] = false;
+                counters->dropped_games++;
+                continue;
+            }
+        }
+
+        out[winner]++;
+        in[game->loser]++;
+    }
+
+    /* the kept games of every player as winner and as loser */
+    edge_t *won_first = arena_alloc(arena, sizeof(edge_t) * (player_count + 1));
+    edge_t *lost_first = arena_alloc(arena, sizeof(edge_t) * (player_count + 1));
+    edge_t *won = arena_alloc(arena, sizeof(edge_t) * game_count);
+    edge_t *lost = arena_alloc(arena, sizeof(edge_t) * game_count);
+
+    won_first[0] = 0;
+    lost_first[0] = 0;
+
+    for (player_idx_t player_idx = 0; player_idx < player_count; player_idx++) {
+        won_first[player_idx + 1] = won_first[player_idx] + out[player_idx];
+        lost_first[player_idx + 1] = lost_first[player_idx] + in[player_idx];
+    }
+
+    /* spent doubles as the fill cursors, won in the low half, lost in the high */
+    edge_t *won_fill = (edge_t *) spent;
+    edge_t *lost_fill = won_fill + player_count;
+
+    memcpy(won_fill, won_first, sizeof(edge_t) * player_count);
+    memcpy(lost_fill, lost_first, sizeof(edge_t) * player_count);
+
+    for (edge_t game_idx = 0; game_idx < game_count; game_idx++) {
+        if (tournament->kept[game_idx]) {
+            won[won_fill[input->games[game_idx].winner]++] = game_idx;
+            lost[lost_fill[input->games[game_idx].loser]++] = game_idx;
+        }
+    }
+
+    /* peel stuck and barren players, which may leave others so */
+    player_idx_t *pending = arena_alloc(arena, sizeof(player_idx_t) * player_count);
+    player_idx_t pending_count = 0;
+
+    for (player_idx_t player_idx = 0; player_idx < player_count; player_idx++) {
+        if (stuck_player(tournament, out, in, player_idx)
+                || barren_player(tournament, out, in, player_idx)) {
+            pending[pending_count++] = player_idx;
+        }
+    }
+
+    while (pending_count > 0) {
+        const player_idx_t player = pending[--pending_count];
+        const bool stuck = stuck_player(tournament, out, in, player);
+
+        edge_t begin = stuck ? lost_first[player] : won_first[player];
+        edge_t end = stuck ? lost_first[player + 1] : won_first[player + 1];
+        const edge_t *games = stuck ? lost : won;
+
+        for (edge_t e = begin; e < end; e++) {
+            const edge_t game_idx = games[e];
+            const player_idx_t winner = input->games[game_idx].winner;
+            const player_idx_t loser = input->games[game_idx].loser;
+
+            if (!tournament->kept[game_idx]) {
+                continue;
+            }
+
+            tournament->kept[game_idx] = false;
+            counters->dropped_games++;
+
+            out[winner]--;
+            in[loser]--;
+
+            /* the winner may have lost its last way out, the loser its last way in */
+            if (stuck && stuck_player(tournament, out, in, winner)) {
+                pending[pending_count++] = winner;
+            } else if (!stuck && barren_player(tournament, out, in, loser)) {
+                pending[pending_count++] = loser;
+            }
+        }
+    }
+
+    unit_t lo = tournament->first_limit;
+    unit_t hi = min(tournament->last_limit, wins[0] + in[0]);
+    vertex_t vertex = 1;
+
+    for (player_idx_t player_idx = 0; player_idx < player_count; player_idx++) {
+        if (player_idx != 0 && out[player_idx] == 0 && in[player_idx] == 0) {
+            lo = max(lo, wins[player_idx]);
+
+            tournament->player_vertex[player_idx] = 0;
+            tournament->point_count -= wins[player_idx];
+            counters->fixed_players++;
+        } else {
+            tournament->player_vertex[player_idx] = vertex++;
+        }
+    }
+
+    counters->bound_skips += (tournament->last_limit - tournament->first_limit)
+        - max(hi - lo, -1);
+
+    tournament->player_count = vertex - 1;
+    tournament->first_limit = lo;
+    tournament->last_limit = hi;
+}
+
+bool
+SOLVE_TOURNAMENT(struct solver *solver, const struct tournament_input *input)
+{
+    const struct options *options = solver->options;
+    struct arena *arena = &solver->arena;
+    const int64_t started = now_usec();
+
+    const player_idx_t player_count = input->player_count;
+    const cost_t budget = input->budget;
+
+    /* nothing to solve, the row of the stats stream is still owed */
+    if (player_count <= 1) {
+        if (options->stats != STATS_NONE) {
+            const struct counters counters = { 0 };
+
+            print_stats(options->stats, input, &counters, now_usec() - started, true);
+        }
+
+        return true;
+    }
+
+    edge_t game_count = ((player_count * (player_count - 1)) / 2);
+    unit_t max_points = UNIT_MIN;
+
+    vertex_t player_offset_l = 1;
+
+    struct network network;
+    /* memset(&network, 0, sizeof(struct network)); */
+
+    /* counted before there is a network to count in */
+    struct counters counters = { 0 };
+
+    arena_reset(arena);
+
+    struct tournament tournament = {
+        .player_count = player_count,
+        .game_count = game_count,
+        .point_count = game_count,
+        .budget = budget,
+        .timed = options->stats != STATS_NONE,
+        .warm_start = options->warm_start,
+        .solved_limit = UNIT_MIN,
+        .prune = options->prune,
+        .wins = arena_alloc(arena, sizeof(unit_t) * player_count),
+        .player_vertex = arena_alloc(arena, sizeof(vertex_t) * player_count),
+        .kept = arena_alloc(arena, sizeof(bool) * game_count),
+        .network = &network,
+    };
+
+    memset(tournament.wins, 0, sizeof(unit_t) * player_count);
+
+    for (edge_t game_idx = 0; game_idx < game_count; game_idx++) {
+        const struct game *game = &input->games[game_idx];
+
+        tournament.wins[game->winner]++;
+        tournament.kept[game_idx] = game->bribe <= budget;
+    }
+
+    for (player_idx_t player_idx = 0; player_idx < player_count; player_idx++) {
+        tournament.player_vertex[player_idx] = player_offset_l + player_idx;
+        max_points = max(max_points, tournament.wins[player_idx]);
+    }
+
+    tournament.max_points = max_points;
+    tournament.first_limit = player_count / 2;
+    tournament.last_limit = max_points;
+
+    if (tournament.prune) {
+        prune_limits(&tournament, input, arena, &counters);
+
+        if (tournament.first_limit <= tournament.last_limit) {
+            reduce_network(&tournament, input, arena, &counters);
+        }
+    }
+
+    /* from here on only the players left in the network count */
+    const player_idx_t network_players = tournament.player_count;
+    edge_t kept_count = 0;
+
+    for (edge_t game_idx = 0; game_idx < game_count; game_idx++) {
+        kept_count += tournament.kept[game_idx];
+    }
+
+    /* the players are the dense block, their games nearly fill it */
+    bool dense = options->layout == LAYOUT_DENSE
+        || (options->layout == LAYOUT_AUTO && network_players >= DENSE_MIN_PLAYERS);
+
+    network_init(&network, arena, 1 + network_players + 2,
+                 network_players + kept_count + network_players + 1,
+                 player_offset_l, dense ? network_players : 0);
+
+    network.engine = options->engine;
+    network.counters = counters;
+
+    tournament.raised = arena_alloc(arena, sizeof(edge_t) * network_players);
+    tournament.source_player = arena_alloc(arena, sizeof(edge_t) * network_players);
+    tournament.player_limit = arena_alloc(arena, sizeof(edge_t) * network_players);
+
+#ifdef DDEEBBUUGG__
+    dprintf("netwo\t = %p\n", &network);
+    dprintf("edges\t = %p\n", network.edges);
+    dprintf("srcp \t = %p\n", tournament.source_player);
+    dprintf("plli \t = %p\n", tournament.player_limit);
+    dprintf("dist \t = %p\n", network.dist);
+    dprintf("pare \t = %p\n", network.parent);
+#endif
+
+    vertex_t source_vertex = 0;
+    vertex_t limit_vertex = player_offset_l + network_players;
+    vertex_t sink_vertex = player_offset_l + network_players + 1;
+
+    network.sink = sink_vertex;
+    network.source = source_vertex;
+
+#ifdef DDEEBBUUGG
+    dotdebug("digraph { //c \n");
+    dotdebug("\trankdir=LR;\n");
+
+    dotdebug("\t%lld [label=source];\n", source_vertex);
+    dotdebug("\t%lld [label=limit];\n", limit_vertex);
+    dotdebug("\t%lld [label=sink];\n", sink_vertex);
+#endif
+
+    edge_t cursor = 0;
+    int64_t bribe_total = 0;
+
+    vertex_t player_vertex;
+    for (player_idx_t player_idx = 0; player_idx < player_count; player_idx++) {
+        player_vertex = tournament.player_vertex[player_idx];
+
+        if (player_vertex == 0) {
+            continue;
+        }
+
+        tournament.source_player[player_vertex - player_offset_l] = add_edge(
+                &network, &cursor,
+                source_vertex, player_vertex, tournament.wins[player_idx], 0);
+
+        dotdebug("\t%lld [label=\"%lldl\"];\n",
+                player_vertex, player_idx);
+    }
+
+
+    for (edge_t game_idx = 0; game_idx < game_count; game_idx++) {
+        const player_idx_t winner = input->games[game_idx].winner;
+        const player_idx_t loser = input->games[game_idx].loser;
+        const cost_t bribe = input->games[game_idx].bribe;
+
+        if (!tournament.kept[game_idx]) {
+            continue;
+        }
+
+        add_edge(&network, &cursor,
+                 tournament.player_vertex[winner], tournament.player_vertex[loser],
+                 1, bribe);
+
+        bribe_total += bribe;
+
+    }
+
+    for (player_idx_t player_idx = 0; player_idx < network_players; player_idx++) {
+        player_vertex = player_offset_l + player_idx;
+
+        dotdebug("\t%lld [label=p%lld]\n", player_vertex, player_idx);
+
+        vertex_t head = player_idx == 0 ? sink_vertex : limit_vertex;
+
+        tournament.player_limit[player_idx] = add_edge(
+                &network, &cursor,
+                player_vertex, head, 1, 0);
+
+    }
+
+    tournament.limit_sink = add_edge(&network, &cursor,
+             limit_vertex, sink_vertex, 1, 0);
+
+    bool found = false;
+
+    dprintf("budget = %lld\n", budget);
+    dprintf("max_points = %lld\n", max_points);
+    dprintf("player_count = %lld\n", player_count);
+
+    dprintf("======== %d\n", cursor);
+    network.edge_count = cursor;
+    network_layout(&network);
+
+    network.counters.build_usec = now_usec() - started;
+
+    tournament.deficit_cost = bribe_total + 1;
+
+    if (options->speculate > 1 && network_players >= SPECULATE_MIN_PLAYERS
+            && tournament.first_limit < tournament.last_limit) {
+        found = search_speculative(&tournament, min(options->speculate,
+                    tournament.last_limit - tournament.first_limit + 1));
+    } else if (options->search == SEARCH_BINARY) {
+        found = search_binary(&tournament);
+    } else {
+        found = search_linear(&tournament);
+    }
+
+    if (options->verbose) {
+        fprintf(stderr, "case = %d, players = %d, solves = %lld, "
+                "augmentations = %lld, usec = %lld, %s\n", 
+                input->index, player_count, 
+                (long long) network.counters.limits, 
+                (long long) network.counters.augmentations, 
+                (long long) (now_usec() - started), found ? "TAK" : "NIE");
+    }
+
+    if (options->stats != STATS_NONE) {
+        print_stats(options->stats, input, &network.counters, 
+                    now_usec() - started, found);
+    }
+
+#ifdef DDEEBBUUGG
+    for (edge_t e = 0; e < network.edge_count; e++) {
+        struct edge *edge = &network.edges[e];
+
+        dotdebug("\t%lld -> %lld [label=\"%lld, %lld, %lld\"];\n", 
+                 edge->tail, edge->head, 
+                 edge_capacity(&network, e), edge->cost, edge_flow(&network, e));
+
+    }
+    dotdebug("}\n");
+#endif
+
+    return found;
+}
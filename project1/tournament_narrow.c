@@ -0,0 +1,7 @@
+/* up to 32767 games and costs well inside 32 bits, half the bytes per arc */
+#define MCF_VERTEX_T int16_t
+#define MCF_UNIT_T int16_t
+#define MCF_COST_T int32_t
+#define SOLVE_TOURNAMENT solve_tournament_narrow
+
+#include "tournament.h"
@@ -0,0 +1,8 @@
+/* any input, 64 bit costs so that total_cost cannot overflow */
+#define MCF_VERTEX_T int32_t
+#define MCF_UNIT_T int32_t
+#define MCF_COST_T int64_t
+#define SOLVE_TOURNAMENT solve_tournament_wide
+
+#include "tournament.h"
+#include "what_if.h"
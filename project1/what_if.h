@@ -0,0 +1,361 @@
+/*
+ * What-if sessions over one tournament, included by tournament_wide.c right
+ * after tournament.h. A session keeps its network solved for one limit, flow
+ * maximum and of minimum cost, from one edit to the next: a bribe changed, a
+ * result flipped or another budget. An edit changes a capacity or cost of a
+ * few edges, every change keeping the flow of minimum cost, after which the
+ * flow is topped up again, a few shortest paths at most. The limits are only
+ * searched again once the limit held is not feasible any more.
+ *
+ * Every game has an edge each way, the one against its result and those of
+ * games over budget closed at zero capacity. Nothing is pruned or reduced,
+ * both depending on the bribes and the budget that edits change.
+ */
+
+struct what_if {
+    struct tournament tournament;
+    struct network network;
+    struct arena arena;
+
+    /* the case with every edit so far */
+    struct tournament_input input;
+
+    /* per game the edge along its result as read and the one against it */
+    edge_t *game_edge;
+    bool *flipped;
+
+    /*
+     * every game as bribe_key(), sorted, so that a budget edit finds the
+     * games it opens or closes without looking at the others
+     */
+    int64_t *by_bribe;
+
+    enum search search;
+    bool answer;
+};
+
+static edge_t
+game_active_edge(const struct what_if *what_if, edge_t game_idx)
+{
+    return what_if->game_edge[2 * game_idx + what_if->flipped[game_idx]];
+}
+
+/* orders games by bribe, then index, as one integer, the index its low half */
+static int64_t
+bribe_key(int64_t bribe, edge_t game_idx)
+{
+    return (int64_t) bribe * ((int64_t) 1 << 32) + game_idx;
+}
+
+/* the first of what_if->by_bribe not below `key` */
+static edge_t
+bribe_rank(const struct what_if *what_if, int64_t key)
+{
+    edge_t low = 0;
+    edge_t high = what_if->tournament.game_count;
+
+    while (low < high) {
+        edge_t middle = low + (high - low) / 2;
+
+        if (what_if->by_bribe[middle] < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/* one unit of capacity more or less, the flow kept of minimum cost */
+static void
+change_capacity(struct network *network, edge_t edge, int delta)
+{
+    if (delta > 0) {
+        raise_capacities(network, &edge, 1);
+    } else if (delta < 0) {
+        lower_capacity(network, edge);
+    }
+}
+
+/*
+ * Tops the flow of the limit held up to a maximum again, answering right
+ * away if that limit is still feasible, and searches the limits otherwise.
+ */
+static bool
+what_if_resolve(struct what_if *what_if)
+{
+    struct tournament *tournament = &what_if->tournament;
+    struct network *network = tournament->network;
+
+    if (tournament->player_count <= 1) {
+        return what_if->answer = true;
+    }
+
+    if (tournament->solved_limit != UNIT_MIN) {
+        network->cost_limit = COST_MAX;
+        maxflow(network);
+
+        if (network->total_cost <= tournament->budget
+                && network->total_flow == tournament->point_count) {
+            return what_if->answer = true;
+        }
+    }
+
+    tournament->max_points = 0;
+    for (player_idx_t player_idx = 0; player_idx < tournament->player_count;
+            player_idx++) {
+        tournament->max_points = max(tournament->max_points,
+                                     tournament->wins[player_idx]);
+    }
+
+    tournament->first_limit = tournament->player_count / 2;
+    tournament->last_limit = tournament->max_points;
+
+    if (what_if->search == SEARCH_BINARY) {
+        what_if->answer = search_binary(tournament);
+    } else {
+        what_if->answer = search_linear(tournament);
+    }
+
+    return what_if->answer;
+}
+
+struct what_if *
+what_if_open(const struct options *options, const struct tournament_input *input)
+{
+    struct what_if *what_if = valloc(sizeof(struct what_if));
+    struct arena *arena = &what_if->arena;
+    struct network *network = &what_if->network;
+    struct tournament *tournament = &what_if->tournament;
+
+    const player_idx_t player_count = input->player_count;
+    const edge_t game_count = max(player_count, 1) * (max(player_count, 1) - 1) / 2;
+    const vertex_t player_offset = 1;
+
+    memset(what_if, 0, sizeof(struct what_if));
+
+    what_if->search = options->search;
+    what_if->input = *input;
+    what_if->input.games = arena_alloc(arena, sizeof(struct game) * game_count);
+    memcpy(what_if->input.games, input->games, sizeof(struct game) * game_count);
+
+    what_if->game_edge = arena_alloc(arena, sizeof(edge_t) * 2 * game_count);
+    what_if->flipped = arena_alloc(arena, sizeof(bool) * game_count);
+    memset(what_if->flipped, 0, sizeof(bool) * game_count);
+
+    what_if->by_bribe = arena_alloc(arena, sizeof(int64_t) * game_count);
+    for (edge_t game_idx = 0; game_idx < game_count; game_idx++) {
+        what_if->by_bribe[game_idx] = bribe_key(input->games[game_idx].bribe, game_idx);
+    }
+    qsort(what_if->by_bribe, game_count, sizeof(int64_t), compare_bribes);
+
+    /* no games, nothing to flow, nobody beats player 0 */
+    if (player_count <= 1) {
+        what_if->answer = true;
+        return what_if;
+    }
+
+    bool dense = options->layout == LAYOUT_DENSE
+        || (options->layout == LAYOUT_AUTO && player_count >= DENSE_MIN_PLAYERS);
+
+    network_init(network, arena, 1 + player_count + 2,
+                 player_count + 2 * game_count + player_count + 1,
+                 player_offset, dense ? player_count : 0);
+
+    network->engine = options->engine;
+    network->source = 0;
+    network->sink = player_offset + player_count + 1;
+
+    const vertex_t limit_vertex = player_offset + player_count;
+
+    *tournament = (struct tournament) {
+        .player_count = player_count,
+        .game_count = game_count,
+        .point_count = game_count,
+        .budget = input->budget,
+        .warm_start = options->warm_start,
+        .solved_limit = UNIT_MIN,
+        .prune = false,
+        .wins = arena_alloc(arena, sizeof(unit_t) * player_count),
+        .raised = arena_alloc(arena, sizeof(edge_t) * player_count),
+        .network = network,
+        .source_player = arena_alloc(arena, sizeof(edge_t) * player_count),
+        .player_limit = arena_alloc(arena, sizeof(edge_t) * player_count),
+    };
+
+    int64_t bribe_total = 0;
+    edge_t cursor = 0;
+
+    memset(tournament->wins, 0, sizeof(unit_t) * player_count);
+
+    for (edge_t game_idx = 0; game_idx < game_count; game_idx++) {
+        tournament->wins[input->games[game_idx].winner]++;
+    }
+
+    for (player_idx_t player_idx = 0; player_idx < player_count; player_idx++) {
+        tournament->source_player[player_idx] = add_edge(network, &cursor,
+                network->source, player_offset + player_idx,
+                tournament->wins[player_idx], 0);
+    }
+
+    for (edge_t game_idx = 0; game_idx < game_count; game_idx++) {
+        const struct game *game = &input->games[game_idx];
+        const vertex_t winner_vertex = player_offset + game->winner;
+        const vertex_t loser_vertex = player_offset + game->loser;
+
+        what_if->game_edge[2 * game_idx] = add_edge(network, &cursor,
+                winner_vertex, loser_vertex, game->bribe <= input->budget, game->bribe);
+        what_if->game_edge[2 * game_idx + 1] = add_edge(network, &cursor,
+                loser_vertex, winner_vertex, 0, game->bribe);
+
+        bribe_total += game->bribe < 0 ? -game->bribe : game->bribe;
+    }
+
+    for (player_idx_t player_idx = 0; player_idx < player_count; player_idx++) {
+        vertex_t head = player_idx == 0 ? network->sink : limit_vertex;
+
+        tournament->player_limit[player_idx] = add_edge(network, &cursor,
+                player_offset + player_idx, head, 1, 0);
+    }
+
+    tournament->limit_sink = add_edge(network, &cursor,
+            limit_vertex, network->sink, 1, 0);
+
+    network->edge_count = cursor;
+    network_layout(network);
+
+    /* above the cost of any flow whatever the edits, kept so as bribes change */
+    tournament->deficit_cost = bribe_total + 1;
+
+    what_if_resolve(what_if);
+    return what_if;
+}
+
+bool
+what_if_answer(const struct what_if *what_if)
+{
+    return what_if->answer;
+}
+
+bool
+what_if_set_bribe(struct what_if *what_if, int32_t game_idx, int32_t bribe)
+{
+    struct tournament *tournament = &what_if->tournament;
+    struct network *network = &what_if->network;
+
+    if (game_idx < 0 || game_idx >= tournament->game_count) {
+        return false;
+    }
+
+    struct game *game = &what_if->input.games[game_idx];
+    const edge_t active = game_active_edge(what_if, game_idx);
+    const bool was_open = game->bribe <= tournament->budget;
+    const bool open = bribe <= tournament->budget;
+
+    tournament->deficit_cost += (bribe < 0 ? -(int64_t) bribe : bribe)
+        - (game->bribe < 0 ? -(int64_t) game->bribe : game->bribe);
+
+    if (was_open && !open) {
+        change_capacity(network, active, -1);
+    }
+
+    set_edge_cost(network, what_if->game_edge[2 * game_idx], bribe);
+    set_edge_cost(network, what_if->game_edge[2 * game_idx + 1], bribe);
+
+    /* the games between the old and the new key shift over by one */
+    const int64_t old_key = bribe_key(game->bribe, game_idx);
+    const int64_t key = bribe_key(bribe, game_idx);
+    const edge_t from = bribe_rank(what_if, old_key);
+    int64_t *by_bribe = what_if->by_bribe;
+
+    if (key > old_key) {
+        const edge_t to = bribe_rank(what_if, key) - 1;
+
+        memmove(&by_bribe[from], &by_bribe[from + 1], sizeof(int64_t) * (to - from));
+        by_bribe[to] = key;
+    } else {
+        const edge_t to = bribe_rank(what_if, key);
+
+        memmove(&by_bribe[to + 1], &by_bribe[to], sizeof(int64_t) * (from - to));
+        by_bribe[to] = key;
+    }
+
+    game->bribe = bribe;
+
+    if (!was_open && open) {
+        change_capacity(network, active, 1);
+    }
+
+    what_if_resolve(what_if);
+    return true;
+}
+
+bool
+what_if_flip(struct what_if *what_if, int32_t game_idx)
+{
+    struct tournament *tournament = &what_if->tournament;
+    struct network *network = &what_if->network;
+
+    if (game_idx < 0 || game_idx >= tournament->game_count) {
+        return false;
+    }
+
+    struct game *game = &what_if->input.games[game_idx];
+    const player_idx_t winner = game->winner;
+    const player_idx_t loser = game->loser;
+    const bool open = game->bribe <= tournament->budget;
+
+    if (open) {
+        change_capacity(network, game_active_edge(what_if, game_idx), -1);
+    }
+
+    what_if->flipped[game_idx] = !what_if->flipped[game_idx];
+    game->winner = loser;
+    game->loser = winner;
+
+    if (open) {
+        change_capacity(network, game_active_edge(what_if, game_idx), 1);
+    }
+
+    tournament->wins[winner]--;
+    tournament->wins[loser]++;
+
+    change_capacity(network, tournament->source_player[winner], -1);
+    change_capacity(network, tournament->source_player[loser], 1);
+
+    what_if_resolve(what_if);
+    return true;
+}
+
+void
+what_if_set_budget(struct what_if *what_if, int32_t budget)
+{
+    struct tournament *tournament = &what_if->tournament;
+    const cost_t old_budget = tournament->budget;
+    const int delta = budget > old_budget ? 1 : -1;
+
+    /* only the games with bribes in (low, high] open or close */
+    const int64_t low = min(old_budget, (cost_t) budget);
+    const int64_t high = max(old_budget, (cost_t) budget);
+    const edge_t first = bribe_rank(what_if, bribe_key(low, INT32_MAX) + 1);
+    const edge_t last = bribe_rank(what_if, bribe_key(high, INT32_MAX) + 1);
+
+    for (edge_t rank = first; rank < last; rank++) {
+        const edge_t game_idx = (edge_t) (what_if->by_bribe[rank] & UINT32_MAX);
+
+        change_capacity(&what_if->network, game_active_edge(what_if, game_idx), delta);
+    }
+
+    tournament->budget = budget;
+    what_if->input.budget = budget;
+
+    what_if_resolve(what_if);
+}
+
+void
+what_if_close(struct what_if *what_if)
+{
+    arena_release(&what_if->arena);
+    free(what_if);
+}
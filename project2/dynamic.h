@@ -0,0 +1,675 @@
+/*
+ * Dynamic mode, --dynamic, included by main.c after the analytics. The graph
+ * is kept as its maximal cliques and a clique tree of every component,
+ * seeded from the analytics' forest, and edited an edge at a time (Ibarra's
+ * fully dynamic chordal graphs):
+ *
+ * - uv with common neighbours joins the graph chordal iff on the tree path
+ *   between the cliques with u and those with v some separator is no larger
+ *   than what the two cliques at its ends share. The path runs through
+ *   cliques that all hold any one common neighbour, so only those of the one
+ *   in fewest cliques are searched. That edge of the tree gives way to one
+ *   between the cliques at the ends, and the one new maximal clique, the
+ *   shared vertices with u and v, goes in between them, taking in either if
+ *   it was all of it but u or v.
+ * - uv without common neighbours closes a chordless cycle unless it joins
+ *   two components, told apart by a label per tree. The new clique is then
+ *   just u and v, joining the two trees, the smaller taking the label of the
+ *   other.
+ * - uv leaves the graph chordal iff exactly one maximal clique holds both.
+ *   It splits into the clique without v and the one without u, each taken
+ *   in by a neighbour in the tree that holds all of it. Sharing nothing the
+ *   two are apart, the smaller tree then labelled anew.
+ *
+ * An edit costs the cliques of its ends and their neighbours, and the
+ * search: the cliques of a common neighbour, or the smaller of two trees
+ * joined or split. The clique number follows from a count of the maximal cliques
+ * of every size. Edges are simple, inserting one already there and deleting
+ * one not there change nothing.
+ */
+
+#define NO_CLIQUE ((vertex_t) -1)
+
+/* vertex or clique indices, in order where they are a clique's vertices */
+struct dyn_list {
+    vertex_t              *items;
+    vertex_t               count;
+    vertex_t               capacity;
+};
+
+struct dyn_clique {
+    struct dyn_list        members;
+    struct dyn_list        tree;    /* its neighbours in the clique tree */
+};
+
+struct dynamic {
+    vertex_t               vertex_count;
+
+    /* never more maximal cliques than vertices, one more while editing */
+    struct dyn_clique     *cliques;
+    struct dyn_list        free_cliques;
+
+    struct dyn_list       *cliques_of; /* per vertex */
+
+    /* per clique the label of its tree, one per component */
+    vertex_t              *tree_label;
+    vertex_t               label_count;
+
+    /* per size the maximal cliques of it, and the largest size there is */
+    vertex_t              *size_count;
+    vertex_t               max_clique;
+
+    /* the tree searches, per clique the one it was reached from */
+    vertex_t              *search_from;
+    vertex_t              *search_seen;
+    vertex_t               search;
+    struct dyn_list        queue;
+    struct dyn_list        other_queue;
+
+    /* per vertex, for the neighbours of an end */
+    vertex_t              *vertex_seen;
+    vertex_t               mark;
+
+    struct dyn_list        shared;
+};
+
+static void
+list_push(struct dyn_list *list, vertex_t item)
+{
+    if (list->count == list->capacity) {
+        list->capacity = max(2 * list->capacity, 4);
+        list->items = realloc(list->items, sizeof(vertex_t) * list->capacity);
+    }
+
+    list->items[list->count++] = item;
+}
+
+/* the order not kept */
+static void
+list_remove(struct dyn_list *list, vertex_t item)
+{
+    for (vertex_t i = 0; i < list->count; i++) {
+        if (list->items[i] == item) {
+            list->items[i] = list->items[--list->count];
+            return;
+        }
+    }
+}
+
+static bool
+members_have(const struct dyn_list *members, vertex_t v)
+{
+    vertex_t lo = 0;
+    vertex_t hi = members->count;
+
+    while (lo < hi) {
+        const vertex_t mid = lo + (hi - lo) / 2;
+
+        if (members->items[mid] < v) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo < members->count && members->items[lo] == v;
+}
+
+/* the vertices `a` and `b` share, into `shared` unless NULL, and their count */
+static vertex_t
+members_shared(const struct dyn_list *a, const struct dyn_list *b,
+               struct dyn_list *shared)
+{
+    vertex_t count = 0;
+
+    for (vertex_t i = 0, j = 0; i < a->count && j < b->count;) {
+        if (a->items[i] < b->items[j]) {
+            i++;
+        } else if (a->items[i] > b->items[j]) {
+            j++;
+        } else {
+            if (shared != NULL) {
+                list_push(shared, a->items[i]);
+            }
+
+            count++;
+            i++;
+            j++;
+        }
+    }
+
+    return count;
+}
+
+static int
+vertex_cmp(const void *a, const void *b)
+{
+    const vertex_t x = *(const vertex_t *) a;
+    const vertex_t y = *(const vertex_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+static void
+clique_count(struct dynamic *dyn, vertex_t c, int delta)
+{
+    const vertex_t size = dyn->cliques[c].members.count;
+
+    dyn->size_count[size] += delta;
+
+    if (delta > 0) {
+        dyn->max_clique = max(dyn->max_clique, size);
+    }
+}
+
+/* an empty clique, not counted and in no tree */
+static vertex_t
+clique_new(struct dynamic *dyn)
+{
+    const vertex_t c = dyn->free_cliques.items[--dyn->free_cliques.count];
+
+    dyn->cliques[c].members.count = 0;
+    dyn->cliques[c].tree.count = 0;
+
+    return c;
+}
+
+/* `members` in order, the clique counted and found from every member */
+static void
+clique_fill(struct dynamic *dyn, vertex_t c, const vertex_t *members, vertex_t count)
+{
+    struct dyn_list *list = &dyn->cliques[c].members;
+
+    for (vertex_t i = 0; i < count; i++) {
+        list_push(list, members[i]);
+        list_push(&dyn->cliques_of[members[i]], c);
+    }
+
+    clique_count(dyn, c, 1);
+}
+
+static void
+tree_link(struct dynamic *dyn, vertex_t a, vertex_t b)
+{
+    list_push(&dyn->cliques[a].tree, b);
+    list_push(&dyn->cliques[b].tree, a);
+}
+
+static void
+tree_unlink(struct dynamic *dyn, vertex_t a, vertex_t b)
+{
+    list_remove(&dyn->cliques[a].tree, b);
+    list_remove(&dyn->cliques[b].tree, a);
+}
+
+/* `c`, all of it in its neighbour `into`, gone and its neighbours `into`'s */
+static void
+clique_absorb(struct dynamic *dyn, vertex_t c, vertex_t into)
+{
+    struct dyn_clique *clique = &dyn->cliques[c];
+
+    tree_unlink(dyn, c, into);
+
+    while (clique->tree.count > 0) {
+        const vertex_t n = clique->tree.items[0];
+
+        tree_unlink(dyn, c, n);
+        tree_link(dyn, n, into);
+    }
+
+    clique_count(dyn, c, -1);
+
+    for (vertex_t i = 0; i < clique->members.count; i++) {
+        list_remove(&dyn->cliques_of[clique->members.items[i]], c);
+    }
+
+    clique->members.count = 0;
+    list_push(&dyn->free_cliques, c);
+}
+
+/* `c` taken in by a neighbour holding all of it, if there is one */
+static void
+clique_absorb_if_inside(struct dynamic *dyn, vertex_t c)
+{
+    const struct dyn_clique *clique = &dyn->cliques[c];
+
+    for (vertex_t i = 0; i < clique->tree.count; i++) {
+        const vertex_t n = clique->tree.items[i];
+        const struct dyn_list *members = &dyn->cliques[n].members;
+
+        if (members->count > clique->members.count
+                && members_shared(&clique->members, members, NULL)
+                   == clique->members.count) {
+            clique_absorb(dyn, c, n);
+            return;
+        }
+    }
+}
+
+/* how many cliques hold both `u` and `v`, the last of them into `found` */
+static vertex_t
+clique_with(const struct dynamic *dyn, vertex_t u, vertex_t v, vertex_t *found)
+{
+    const struct dyn_list *of = &dyn->cliques_of[u];
+    vertex_t count = 0;
+
+    *found = NO_CLIQUE;
+
+    for (vertex_t i = 0; i < of->count; i++) {
+        if (members_have(&dyn->cliques[of->items[i]].members, v)) {
+            *found = of->items[i];
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/*
+ * From the analytics of the graph max_clique() went over, every clique the
+ * vertex last added to it and that vertex's visited neighbours.
+ */
+static void
+dynamic_open(struct dynamic *dyn, struct context *ctx, const struct analytics *analytics)
+{
+    const vertex_t vertex_count = ctx->vertex_count;
+    const vertex_t clique_capacity = vertex_count + 1;
+
+    *dyn = (struct dynamic) {
+        .vertex_count = vertex_count,
+        .cliques = calloc(clique_capacity, sizeof(struct dyn_clique)),
+        .cliques_of = calloc(vertex_count, sizeof(struct dyn_list)),
+        .size_count = calloc(vertex_count + 1, sizeof(vertex_t)),
+        .search_from = valloc(sizeof(vertex_t) * clique_capacity),
+        .search_seen = calloc(clique_capacity, sizeof(vertex_t)),
+        .vertex_seen = calloc(vertex_count, sizeof(vertex_t)),
+        .tree_label = valloc(sizeof(vertex_t) * clique_capacity),
+    };
+
+    for (vertex_t c = clique_capacity; c > analytics->clique_count; c--) {
+        list_push(&dyn->free_cliques, c - 1);
+    }
+
+    vertex_t *scratch = valloc(sizeof(vertex_t) * vertex_count);
+
+    for (vertex_t c = 0; c < analytics->clique_count; c++) {
+        const vertex_t last = analytics->clique_last[c];
+        const vertex_t pos = ctx->vertices[last].pos;
+
+        vertex_t adj_count;
+        const vertex_t *adj = neighbours(ctx, last, scratch, &adj_count);
+
+        dyn->shared.count = 0;
+        list_push(&dyn->shared, last);
+
+        for (vertex_t a = 0; a < adj_count; a++) {
+            const vertex_t pos_a = ctx->vertices[adj[a]].pos;
+
+            if (pos_a > 0 && pos_a < pos) {
+                list_push(&dyn->shared, adj[a]);
+            }
+        }
+
+        /* parallel edges repeat a neighbour */
+        struct dyn_list *shared = &dyn->shared;
+        vertex_t count = 0;
+
+        qsort(shared->items, shared->count, sizeof(vertex_t), vertex_cmp);
+
+        for (vertex_t i = 0; i < shared->count; i++) {
+            if (i == 0 || shared->items[i] != shared->items[i - 1]) {
+                shared->items[count++] = shared->items[i];
+            }
+        }
+
+        clique_fill(dyn, c, shared->items, count);
+
+        /* a parent comes before its children */
+        if (analytics->clique_parent[c] != c) {
+            tree_link(dyn, c, analytics->clique_parent[c]);
+            dyn->tree_label[c] = dyn->tree_label[analytics->clique_parent[c]];
+        } else {
+            dyn->tree_label[c] = dyn->label_count++;
+        }
+    }
+
+    free(scratch);
+}
+
+static bool
+dynamic_valid(const struct dynamic *dyn, vertex_t u, vertex_t v)
+{
+    return u != v && u > 0 && v > 0 && u < dyn->vertex_count && v < dyn->vertex_count;
+}
+
+/*
+ * The cliques of the smaller of two trees, those of cliques `a` and `b`,
+ * both searched at once until one runs out.
+ */
+static const struct dyn_list *
+smaller_tree(struct dynamic *dyn, vertex_t a, vertex_t b)
+{
+    struct dyn_list *queues[2] = { &dyn->queue, &dyn->other_queue };
+    const vertex_t starts[2] = { a, b };
+    vertex_t heads[2] = { 0, 0 };
+    vertex_t sides[2];
+
+    for (int side = 0; side < 2; side++) {
+        sides[side] = ++dyn->search;
+        dyn->search_seen[starts[side]] = sides[side];
+
+        queues[side]->count = 0;
+        list_push(queues[side], starts[side]);
+    }
+
+    for (;;) {
+        for (int side = 0; side < 2; side++) {
+            struct dyn_list *queue = queues[side];
+
+            if (heads[side] == queue->count) {
+                return queue;
+            }
+
+            const struct dyn_list *tree = &dyn->cliques[queue->items[heads[side]++]].tree;
+
+            for (vertex_t i = 0; i < tree->count; i++) {
+                const vertex_t n = tree->items[i];
+
+                if (dyn->search_seen[n] != sides[side]) {
+                    dyn->search_seen[n] = sides[side];
+                    list_push(queue, n);
+                }
+            }
+        }
+    }
+}
+
+static void
+relabel(struct dynamic *dyn, const struct dyn_list *cliques, vertex_t label)
+{
+    for (vertex_t i = 0; i < cliques->count; i++) {
+        dyn->tree_label[cliques->items[i]] = label;
+    }
+}
+
+/*
+ * The clique with `v` nearest those with `u`, searched through the cliques
+ * with `s` only, every clique reached with the one it was reached from.
+ */
+static vertex_t
+search_through(struct dynamic *dyn, vertex_t u, vertex_t v, vertex_t s)
+{
+    const struct dyn_list *of = &dyn->cliques_of[u];
+    struct dyn_list *queue = &dyn->queue;
+
+    dyn->search++;
+    queue->count = 0;
+
+    for (vertex_t i = 0; i < of->count; i++) {
+        if (members_have(&dyn->cliques[of->items[i]].members, s)) {
+            dyn->search_seen[of->items[i]] = dyn->search;
+            dyn->search_from[of->items[i]] = of->items[i];
+            list_push(queue, of->items[i]);
+        }
+    }
+
+    for (vertex_t head = 0; head < queue->count; head++) {
+        const struct dyn_list *tree = &dyn->cliques[queue->items[head]].tree;
+
+        for (vertex_t i = 0; i < tree->count; i++) {
+            const vertex_t n = tree->items[i];
+            const struct dyn_list *members = &dyn->cliques[n].members;
+
+            if (dyn->search_seen[n] == dyn->search || !members_have(members, s)) {
+                continue;
+            }
+
+            dyn->search_seen[n] = dyn->search;
+            dyn->search_from[n] = queue->items[head];
+
+            if (members_have(members, v)) {
+                return n;
+            }
+
+            list_push(queue, n);
+        }
+    }
+
+    /* the cliques with s are a tree, with u and v both in it */
+    return NO_CLIQUE;
+}
+
+/* the one clique with `u` and `v`, between `cu` and `cv` and taking in either */
+static void
+clique_between(struct dynamic *dyn, vertex_t cu, vertex_t cv, struct dyn_list *members)
+{
+    const vertex_t k = clique_new(dyn);
+
+    clique_fill(dyn, k, members->items, members->count);
+    dyn->tree_label[k] = dyn->tree_label[cu];
+    tree_link(dyn, cu, k);
+    tree_link(dyn, k, cv);
+
+    if (dyn->cliques[cu].members.count + 1 == members->count) {
+        clique_absorb(dyn, cu, k);
+    }
+    if (dyn->cliques[cv].members.count + 1 == members->count) {
+        clique_absorb(dyn, cv, k);
+    }
+}
+
+/* false, the graph as it was, if uv would close a chordless cycle */
+static bool
+dynamic_insert(struct dynamic *dyn, vertex_t u, vertex_t v)
+{
+    vertex_t found;
+
+    if (!dynamic_valid(dyn, u, v)) {
+        return false;
+    }
+
+    if (dyn->cliques_of[u].count > dyn->cliques_of[v].count) {
+        const vertex_t w = u;
+
+        u = v;
+        v = w;
+    }
+
+    if (clique_with(dyn, u, v, &found) > 0) {
+        return true;
+    }
+
+    /* the neighbours of u, then those of v among them */
+    const struct dyn_list *of = &dyn->cliques_of[u];
+    struct dyn_list *shared = &dyn->shared;
+
+    dyn->mark++;
+    shared->count = 0;
+
+    for (vertex_t i = 0; i < of->count; i++) {
+        const struct dyn_list *members = &dyn->cliques[of->items[i]].members;
+
+        for (vertex_t j = 0; j < members->count; j++) {
+            dyn->vertex_seen[members->items[j]] = dyn->mark;
+        }
+    }
+
+    of = &dyn->cliques_of[v];
+    dyn->mark++;
+
+    for (vertex_t i = 0; i < of->count; i++) {
+        const struct dyn_list *members = &dyn->cliques[of->items[i]].members;
+
+        for (vertex_t j = 0; j < members->count; j++) {
+            if (dyn->vertex_seen[members->items[j]] == dyn->mark - 1) {
+                dyn->vertex_seen[members->items[j]] = dyn->mark;
+                list_push(shared, members->items[j]);
+            }
+        }
+    }
+
+    if (shared->count == 0) {
+        const vertex_t cu = dyn->cliques_of[u].items[0];
+        const vertex_t cv = dyn->cliques_of[v].items[0];
+
+        if (dyn->tree_label[cu] == dyn->tree_label[cv]) {
+            return false;
+        }
+
+        const struct dyn_list *smaller = smaller_tree(dyn, cu, cv);
+
+        relabel(dyn, smaller, dyn->tree_label[smaller->items[0] == cu ? cv : cu]);
+
+        list_push(shared, min(u, v));
+        list_push(shared, max(u, v));
+
+        clique_between(dyn, cu, cv, shared);
+        return true;
+    }
+
+    vertex_t s = shared->items[0];
+    for (vertex_t i = 1; i < shared->count; i++) {
+        if (dyn->cliques_of[shared->items[i]].count < dyn->cliques_of[s].count) {
+            s = shared->items[i];
+        }
+    }
+
+    const vertex_t cv = search_through(dyn, u, v, s);
+    vertex_t cu = cv;
+
+    while (dyn->search_from[cu] != cu) {
+        cu = dyn->search_from[cu];
+    }
+
+    shared->count = 0;
+    members_shared(&dyn->cliques[cu].members, &dyn->cliques[cv].members, shared);
+
+    /* every clique on the path holds the shared vertices, one edge no more */
+    vertex_t cut = cv;
+
+    while (cut != cu && members_shared(&dyn->cliques[cut].members,
+                                       &dyn->cliques[dyn->search_from[cut]].members,
+                                       NULL) != shared->count) {
+        cut = dyn->search_from[cut];
+    }
+
+    if (cut == cu) {
+        return false;
+    }
+
+    tree_unlink(dyn, cut, dyn->search_from[cut]);
+
+    list_push(shared, u);
+    list_push(shared, v);
+    qsort(shared->items, shared->count, sizeof(vertex_t), vertex_cmp);
+
+    clique_between(dyn, cu, cv, shared);
+    return true;
+}
+
+/* false, the graph as it was, if removing uv would leave a chordless cycle */
+static bool
+dynamic_delete(struct dynamic *dyn, vertex_t u, vertex_t v)
+{
+    vertex_t k;
+
+    if (!dynamic_valid(dyn, u, v)) {
+        return false;
+    }
+
+    if (dyn->cliques_of[u].count > dyn->cliques_of[v].count) {
+        const vertex_t w = u;
+
+        u = v;
+        v = w;
+    }
+
+    const vertex_t holding = clique_with(dyn, u, v, &k);
+
+    if (holding != 1) {
+        return holding == 0;
+    }
+
+    /* k loses v, the new kv is k without u */
+    struct dyn_list *shared = &dyn->shared;
+    struct dyn_list *members = &dyn->cliques[k].members;
+    const vertex_t kv = clique_new(dyn);
+
+    shared->count = 0;
+    for (vertex_t i = 0; i < members->count; i++) {
+        if (members->items[i] != u) {
+            list_push(shared, members->items[i]);
+        }
+    }
+
+    clique_fill(dyn, kv, shared->items, shared->count);
+    dyn->tree_label[kv] = dyn->tree_label[k];
+
+    clique_count(dyn, k, -1);
+
+    vertex_t kept = 0;
+    for (vertex_t i = 0; i < members->count; i++) {
+        if (members->items[i] != v) {
+            members->items[kept++] = members->items[i];
+        }
+    }
+
+    members->count = kept;
+    list_remove(&dyn->cliques_of[v], k);
+
+    clique_count(dyn, k, 1);
+
+    /* the neighbours with v go over to kv */
+    struct dyn_list *tree = &dyn->cliques[k].tree;
+
+    for (vertex_t i = 0; i < tree->count;) {
+        const vertex_t n = tree->items[i];
+
+        if (members_have(&dyn->cliques[n].members, v)) {
+            tree_unlink(dyn, k, n);
+            tree_link(dyn, kv, n);
+        } else {
+            i++;
+        }
+    }
+
+    if (shared->count > 1) {
+        tree_link(dyn, k, kv);
+    } else {
+        relabel(dyn, smaller_tree(dyn, k, kv), dyn->label_count++);
+    }
+
+    clique_absorb_if_inside(dyn, k);
+    clique_absorb_if_inside(dyn, kv);
+
+    while (dyn->max_clique > 0 && dyn->size_count[dyn->max_clique] == 0) {
+        dyn->max_clique--;
+    }
+
+    return true;
+}
+
+static void
+dynamic_close(struct dynamic *dyn)
+{
+    for (vertex_t c = 0; c <= dyn->vertex_count; c++) {
+        free(dyn->cliques[c].members.items);
+        free(dyn->cliques[c].tree.items);
+    }
+
+    for (vertex_t v = 0; v < dyn->vertex_count; v++) {
+        free(dyn->cliques_of[v].items);
+    }
+
+    free(dyn->cliques);
+    free(dyn->cliques_of);
+    free(dyn->size_count);
+    free(dyn->search_from);
+    free(dyn->search_seen);
+    free(dyn->free_cliques.items);
+    free(dyn->tree_label);
+    free(dyn->vertex_seen);
+    free(dyn->queue.items);
+    free(dyn->other_queue.items);
+    free(dyn->shared.items);
+}
@@ -4,6 +4,11 @@
 #include <limits.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #if 1
 #undef DDEEBBUUGG
@@ -44,19 +49,73 @@ typedef uint32_t bitmask_t;
 #define BITMASK_SET(bitmask, bit) \
     _BITMASK_ELEM(bitmask, bit) = _BITMASK_ELEM(bitmask, bit) | _BIT(bit)
 
+/* for rows that other threads set bits in at the same time */
+#define BITMASK_SET_ATOMIC(bitmask, bit) \
+    __atomic_fetch_or(&_BITMASK_ELEM(bitmask, bit), _BIT(bit), __ATOMIC_RELAXED)
+
 #define BITMASK_HAS(bitmask, bit) \
     ((_BITMASK_ELEM(bitmask, bit) & _BIT(bit)) == _BIT(bit))
 
+#define BITMASK_CLEAR(bitmask, bit) \
+    _BITMASK_ELEM(bitmask, bit) = _BITMASK_ELEM(bitmask, bit) & ~_BIT(bit)
+
+/*
+ * Widest vector the target has, the bitmask kernels go through this many
+ * bytes of a row at once. Plain GCC vector extensions, so -mavx2 or -mavx512f
+ * turn into the matching instructions; LEX_SCALAR keeps the kernels scalar.
+ * Bitmask rows are padded to a whole number of vectors.
+ */
+#if defined(__AVX512F__)
+#define LEX_VECTOR_BYTES 64
+#elif defined(__AVX2__)
+#define LEX_VECTOR_BYTES 32
+#else
+#define LEX_VECTOR_BYTES 16
+#endif
+
+#define LEX_LANES (LEX_VECTOR_BYTES / sizeof(bitmask_t))
+
+#if defined(__GNUC__) && !defined(LEX_SCALAR)
+typedef bitmask_t mask_lanes __attribute__ ((vector_size (LEX_VECTOR_BYTES)));
+#endif
+
+/*
+ * Adjacency by density: a bitmask row per vertex when the rows take no more
+ * room than lists of the neighbours would, the lists otherwise. Memory is
+ * then O(n + m) on sparse graphs instead of O(n^2) whatever the edges.
+ */
+enum adjacency {
+    ADJ_LIST,
+    ADJ_MASK,
+};
+
 struct vertex {
-    bitmask_t             *adj_mask;
+    bitmask_t             *adj_mask; /* ADJ_MASK */
     vertex_t               peo_pred_count;
 
+    /* ADJ_LIST, the neighbours in ctx->adj; their count either way */
+    vertex_t              *adj;
+    vertex_t               adj_count;
+
+    /* where in ctx->order it is and the class it is in until visited */
+    vertex_t               pos;
+    vertex_t               class_idx;
+    vertex_t               seen_by; /* the last pivot it was counted for */
+
 } __attribute__ ((aligned (ALIGN_TO)));
 
-struct set_node {
-    vertex_t               vertex_idx;
-    bool                   set_ends; 
-    struct set_node       *next;
+/*
+ * A class of the LexBFS partition, the vertices in ctx->order[begin, end).
+ * Vertices adjacent to the pivot move to the front of their class and out
+ * into `split`, a new class right before it, made the first time a pivot
+ * reaches the class.
+ */
+struct lex_class {
+    vertex_t               begin;
+    vertex_t               end;
+
+    vertex_t               split;
+    vertex_t               split_by;
 
 } __attribute__ ((aligned (ALIGN_TO)));
 
@@ -64,200 +123,1199 @@ struct context {
     vertex_t               vertex_count;
     vertex_t               edge_count;
     size_t                 mask_len;
+    enum adjacency         adjacency;
 
     struct vertex         *vertices;
-    
-    struct set_node       *set_list;
+    vertex_t              *adj;
+
+    /* the visited vertices in visit order, then the classes one after another */
+    vertex_t              *order;
+
+    /* at most one class per unvisited vertex, the empty ones given back */
+    struct lex_class      *classes;
+    vertex_t              *free_classes;
+    vertex_t               free_class_count;
+
+    /*
+     * ADJ_MASK: the classes as bitset rows instead, split by whole words of
+     * the pivot's row, in LexBFS order from class_head on.
+     */
+    bitmask_t             *class_masks;
+    vertex_t              *class_size;
+    vertex_t              *class_next;
+    vertex_t               class_head;
+    bitmask_t             *visited;
 
 } __attribute__ ((aligned (ALIGN_TO)));
 
 void
-print_list(struct set_node *node)
+print_classes(struct context *ctx, vertex_t cursor)
 {
-#if 0
-    dprintf("===================================\n");
-    for (struct set_node *i = node; i != NULL; i = i->next) {
-        dprintf("\n");
-        dprintf("(%p)->vertex_idx = %lld\n", i, i->vertex_idx);
-        dprintf("(%p)->set_next   = %d\n",   i, i->set_ends);
-        dprintf("(%p)->next       = %p\n",   i, i->next);
-        dprintf("\n");
-    }
-    dprintf("===================================\n");
-#else
     dprintf("{ ");
-    if (node == NULL) {
-        dprintf("}");
-    }
-    for (struct set_node *i = node; i != NULL; i = i->next) {
-        dprintf("%lld, ", i->vertex_idx);
-        if (i->set_ends) {
+    for (vertex_t p = cursor; p < ctx->vertex_count; p++) {
+        vertex_t v = ctx->order[p];
+        struct lex_class *class = &ctx->classes[ctx->vertices[v].class_idx];
+
+        dprintf("%lld, ", (long long) v);
+        if (p + 1 == class->end) {
             dprintf("}");
 
-            if (i->next != NULL) {
+            if (p + 1 < ctx->vertex_count) {
                 dprintf(", {");
             }
         }
     }
     dprintf("\n");
-#endif
 }
 
 bool
 is_adj(struct context *ctx, vertex_t a, vertex_t b) 
 {
-    return BITMASK_HAS(ctx->vertices[a].adj_mask, b);
+    if (ctx->adjacency == ADJ_MASK) {
+        return BITMASK_HAS(ctx->vertices[a].adj_mask, b);
+    }
+
+    /* the shorter list of the two */
+    if (ctx->vertices[a].adj_count > ctx->vertices[b].adj_count) {
+        vertex_t t = a;
+        a = b;
+        b = t;
+    }
+
+    for (vertex_t i = 0; i < ctx->vertices[a].adj_count; i++) {
+        if (ctx->vertices[a].adj[i] == b) {
+            return true;
+        }
+    }
+
+    return false;
 }
 
+/* the rows with the class rows and the visited row of lex_bfs_mask() counted */
+static size_t
+mask_words(vertex_t vertex_count, size_t mask_len)
+{
+    return (2 * (size_t) vertex_count + 1) * mask_len;
+}
 
-void
-lex_bfs_next(struct context *ctx, struct set_node **node)
+static bool
+choose_mask(vertex_t vertex_count, vertex_t edge_count, size_t mask_len)
+{
+    return (uint64_t) mask_words(vertex_count, mask_len) * sizeof(bitmask_t)
+        <= 2 * (uint64_t) edge_count * sizeof(vertex_t);
+}
+
+static vertex_t
+class_new(struct context *ctx, vertex_t begin)
+{
+    vertex_t class_idx = ctx->free_classes[--ctx->free_class_count];
+    struct lex_class *class = &ctx->classes[class_idx];
+
+    class->begin = begin;
+    class->end = begin;
+    class->split_by = 0;
+
+    return class_idx;
+}
+
+static void
+class_drop_if_empty(struct context *ctx, vertex_t class_idx)
 {
-    struct set_node *next = (*node)->next;
+    if (ctx->classes[class_idx].begin == ctx->classes[class_idx].end) {
+        ctx->free_classes[ctx->free_class_count++] = class_idx;
+    }
+}
 
-    struct set_node *head = NULL;
-    struct set_node *tail = NULL;
+/* counts `w` adjacent to `pivot` and moves it into its class's split */
+static inline void
+lex_refine(struct context *ctx, vertex_t pivot, vertex_t w, vertex_t cursor)
+{
+    struct vertex *vertex = &ctx->vertices[w];
+
+    /* visited, vertex 0 among them, or a parallel edge */
+    if (vertex->pos < cursor || vertex->seen_by == pivot) {
+        return;
+    }
+
+    vertex->seen_by = pivot;
+    vertex->peo_pred_count++;
+
+    const vertex_t class_idx = vertex->class_idx;
+    struct lex_class *class = &ctx->classes[class_idx];
+
+    if (class->split_by != pivot) {
+        class->split_by = pivot;
+        class->split = class_new(ctx, class->begin);
+    }
+
+    struct lex_class *split = &ctx->classes[class->split];
+
+    /* swap w with the first vertex of its class, then move the border */
+    const vertex_t first = ctx->order[class->begin];
+
+    ctx->order[vertex->pos] = first;
+    ctx->vertices[first].pos = vertex->pos;
+
+    ctx->order[class->begin] = w;
+    vertex->pos = class->begin;
+    vertex->class_idx = class->split;
+
+    class->begin++;
+    split->end++;
+
+    class_drop_if_empty(ctx, class_idx);
+}
+
+/*
+ * Visits the vertex at ctx->order[*cursor], the first of the first class,
+ * and refines the classes after it by its neighbours: each one moves to the
+ * front of its class, into the class split off in front. Only the pivot's
+ * neighbours are touched, O(n + m) over the whole search, the bitmask rows
+ * adding O(n^2 / 32) on graphs dense enough to have them. Within a class
+ * the order is not kept, any vertex of the first class is a valid pivot.
+ */
+void
+lex_bfs_next(struct context *ctx, vertex_t *cursor)
+{
+    const vertex_t pivot = ctx->order[*cursor];
+    struct vertex *pivot_vertex = &ctx->vertices[pivot];
 
 #if defined(DDEEBBUUGG) && defined(LEX_DEBUG)
-    dprintf("WHOLE vertex = %lld\n", (*node)->vertex_idx);
-    print_list(*node);
+    dprintf("WHOLE vertex = %lld\n", (long long) pivot);
+    print_classes(ctx, *cursor);
+#endif
+
+    ctx->classes[pivot_vertex->class_idx].begin++;
+    class_drop_if_empty(ctx, pivot_vertex->class_idx);
+
+    (*cursor)++;
+
+    if (ctx->adjacency == ADJ_MASK) {
+        for (size_t m = 0; m < ctx->mask_len; m++) {
+            for (bitmask_t word = pivot_vertex->adj_mask[m]; word != 0;
+                    word &= word - 1) {
+                lex_refine(ctx, pivot, m * BITMASK_BITS + __builtin_ctz(word),
+                           *cursor);
+            }
+        }
+    } else {
+        for (vertex_t a = 0; a < pivot_vertex->adj_count; a++) {
+            lex_refine(ctx, pivot, pivot_vertex->adj[a], *cursor);
+        }
+    }
+
+#if 0 && defined(DDEEBBUUGG) && defined(LEX_DEBUG)
+    dprintf("AFTER \n");
+    print_classes(ctx, *cursor);
+#endif
+}
+
+#if defined(__GNUC__) && !defined(LEX_SCALAR)
+static inline vertex_t
+lanes_popcount(mask_lanes lanes)
+{
+    uint64_t words[sizeof(mask_lanes) / sizeof(uint64_t)];
+    vertex_t count = 0;
+
+    memcpy(words, &lanes, sizeof(mask_lanes));
+
+    for (size_t i = 0; i < sizeof(mask_lanes) / sizeof(uint64_t); i++) {
+        count += __builtin_popcountll(words[i]);
+    }
+
+    return count;
+}
+#endif
+
+/* the bits `a` and `b` have in common */
+static vertex_t
+mask_and_count(const bitmask_t *a, const bitmask_t *b, size_t len)
+{
+    vertex_t count = 0;
+
+#if defined(__GNUC__) && !defined(LEX_SCALAR)
+    for (size_t m = 0; m < len; m += LEX_LANES) {
+        mask_lanes x, y;
+
+        memcpy(&x, &a[m], sizeof(mask_lanes));
+        memcpy(&y, &b[m], sizeof(mask_lanes));
+
+        count += lanes_popcount(x & y);
+    }
+#else
+    for (size_t m = 0; m < len; m++) {
+        count += __builtin_popcount(a[m] & b[m]);
+    }
 #endif
 
-    while (next != NULL) {
-        struct set_node *head_adj     = NULL;
-        struct set_node *tail_adj     = NULL;
+    return count;
+}
+
+/* moves the bits of `class` that `row` has into `split` */
+static void
+mask_split(bitmask_t *class, bitmask_t *split, const bitmask_t *row, size_t len)
+{
+#if defined(__GNUC__) && !defined(LEX_SCALAR)
+    for (size_t m = 0; m < len; m += LEX_LANES) {
+        mask_lanes x, y;
 
-        struct set_node *head_non_adj = NULL;
-        struct set_node *tail_non_adj = NULL;
+        memcpy(&x, &class[m], sizeof(mask_lanes));
+        memcpy(&y, &row[m], sizeof(mask_lanes));
 
-        /* split set */
-        for (struct set_node *i = next; i != NULL; i = next) {
-            next = i->next;
-            i->next = NULL;
+        mask_lanes in = x & y;
+        mask_lanes out = x & ~y;
 
-            struct set_node **append_to_head;
-            struct set_node **append_to_tail;
+        memcpy(&split[m], &in, sizeof(mask_lanes));
+        memcpy(&class[m], &out, sizeof(mask_lanes));
+    }
+#else
+    for (size_t m = 0; m < len; m++) {
+        split[m] = class[m] & row[m];
+        class[m] &= ~row[m];
+    }
+#endif
+}
 
-            if (is_adj(ctx, (*node)->vertex_idx, i->vertex_idx)) {
-                append_to_head = &head_adj;
-                append_to_tail = &tail_adj;
+/* bitmask classes are split while a pass over them costs less than this */
+#define LEX_SPLIT_RATIO 4
 
-                ctx->vertices[i->vertex_idx].peo_pred_count++;
-            } else {
-                append_to_head = &head_non_adj;
-                append_to_tail = &tail_non_adj;
+/*
+ * Lays the bitmask classes out as ranges of ctx->order after the visited
+ * vertices, already in order before `cursor`, for lex_bfs_next() to go on
+ * from there, and gives every vertex left the count of its visited
+ * neighbours.
+ */
+static void
+mask_to_order(struct context *ctx, vertex_t cursor)
+{
+    const size_t len = ctx->mask_len;
+    vertex_t pos = cursor;
+    vertex_t lex_idx = 0;
+
+    for (vertex_t class_idx = ctx->class_head; class_idx != 0;
+            class_idx = ctx->class_next[class_idx], lex_idx++) {
+        const bitmask_t *class = &ctx->class_masks[len * class_idx];
+
+        ctx->classes[lex_idx] = (struct lex_class) { .begin = pos };
+
+        for (size_t m = 0; m < len; m++) {
+            for (bitmask_t word = class[m]; word != 0; word &= word - 1) {
+                const vertex_t v = m * BITMASK_BITS + __builtin_ctz(word);
+                struct vertex *vertex = &ctx->vertices[v];
+
+                vertex->pos = pos;
+                vertex->class_idx = lex_idx;
+                vertex->peo_pred_count = mask_and_count(vertex->adj_mask,
+                                                        ctx->visited, len);
+                ctx->order[pos++] = v;
             }
+        }
+
+        ctx->classes[lex_idx].end = pos;
+    }
+
+    ctx->free_class_count = 0;
+    for (vertex_t class_idx = ctx->vertex_count - 1; class_idx >= lex_idx;
+            class_idx--) {
+        ctx->free_classes[ctx->free_class_count++] = class_idx;
+    }
+}
+
+/*
+ * LexBFS on the bitmask rows, for dense graphs. Every class is a bitset;
+ * the pivot's row splits one with a single AND and ANDNOT pass, after a
+ * popcount pass tells whether it splits at all, and a vertex's predecessors
+ * are a popcount of its row against the visited set. That beats touching
+ * the neighbours one by one while the classes are few, on near cliques, but
+ * vertex numbers say nothing about the classes so every pass is over whole
+ * rows. Once a pass over the live classes costs more than LEX_SPLIT_RATIO
+ * moves per pivot neighbour left, the classes are laid out for
+ * lex_bfs_next() and the search goes on there. Returns the vertices visited,
+ * the vertex count when done.
+ */
+static vertex_t
+lex_bfs_mask(struct context *ctx, uint64_t *max_len)
+{
+    const size_t len = ctx->mask_len;
+    vertex_t class_count = 1;
+    vertex_t cursor;
+
+    for (cursor = 1; cursor < ctx->vertex_count; cursor++) {
+        const vertex_t head = ctx->class_head;
+        bitmask_t *head_mask = &ctx->class_masks[len * head];
+
+        size_t m = 0;
+        while (head_mask[m] == 0) {
+            m++;
+        }
+
+        const vertex_t pivot = m * BITMASK_BITS + __builtin_ctz(head_mask[m]);
+        const bitmask_t *row = ctx->vertices[pivot].adj_mask;
+        const vertex_t pred_count = mask_and_count(row, ctx->visited, len);
 
-            if (*append_to_head == NULL) {
-                *append_to_head = i;
-                *append_to_tail = i;
-            } else {
-                (*append_to_tail)->next = i;
-                *append_to_tail = i;
+        /* the neighbours left, the pivot's own bit never set in visited */
+        const vertex_t adj_left = ctx->vertices[pivot].adj_count - pred_count;
+
+        if ((uint64_t) class_count * (len / LEX_LANES)
+                > (uint64_t) LEX_SPLIT_RATIO * adj_left + len) {
+            mask_to_order(ctx, cursor);
+            return cursor;
+        }
+
+        ctx->vertices[pivot].peo_pred_count = pred_count;
+        ctx->vertices[pivot].pos = cursor;
+        ctx->order[cursor] = pivot;
+        *max_len = max(*max_len, pred_count + 1);
+
+        BITMASK_SET(ctx->visited, pivot);
+        BITMASK_CLEAR(head_mask, pivot);
+
+        if (--ctx->class_size[head] == 0) {
+            ctx->class_head = ctx->class_next[head];
+            ctx->free_classes[ctx->free_class_count++] = head;
+            class_count--;
+        }
+
+        /* the split goes in before the class, prev_next where it links */
+        vertex_t *prev_next = &ctx->class_head;
+
+        for (vertex_t class_idx = ctx->class_head; class_idx != 0;
+                class_idx = ctx->class_next[class_idx]) {
+            bitmask_t *class = &ctx->class_masks[len * class_idx];
+            const vertex_t adjacent = mask_and_count(class, row, len);
+
+            if (adjacent > 0 && adjacent < ctx->class_size[class_idx]) {
+                const vertex_t split_idx = ctx->free_classes[--ctx->free_class_count];
+
+                mask_split(class, &ctx->class_masks[len * split_idx], row, len);
+
+                ctx->class_size[split_idx] = adjacent;
+                ctx->class_size[class_idx] -= adjacent;
+
+                ctx->class_next[split_idx] = class_idx;
+                *prev_next = split_idx;
+                class_count++;
             }
 
-            if (i->set_ends) {
-                break;
+            prev_next = &ctx->class_next[class_idx];
+        }
+    }
+
+    return cursor;
+}
+
+uint64_t
+max_clique(struct context *ctx)
+{
+    vertex_t cursor = 1;
+    uint64_t max_len = 1;
+
+    if (ctx->adjacency == ADJ_MASK) {
+        cursor = lex_bfs_mask(ctx, &max_len);
+    }
+
+    while (cursor < ctx->vertex_count) {
+        max_len = max(max_len, 
+                      ctx->vertices[ctx->order[cursor]].peo_pred_count + 1);
+
+        lex_bfs_next(ctx, &cursor);
+    }
+
+    return max_len;
+}
+
+/* what a game is asked for, --metrics; none asks for the plain answer */
+enum metric {
+    METRIC_CLIQUE      = 1 << 0,
+    METRIC_CHROMATIC   = 1 << 1,
+    METRIC_INDEPENDENT = 1 << 2,
+    METRIC_CLIQUES     = 1 << 3,
+    METRIC_TREE        = 1 << 4,
+};
+
+struct options {
+    unsigned               metrics;
+    int                    jobs;
+    bool                   dynamic;
+};
+
+/*
+ * Everything derived from one LexBFS order, read as a perfect elimination
+ * ordering backwards. The maximal cliques are the sets of a vertex and its
+ * visited neighbours that no later vertex extends, a later vertex extending
+ * the clique of its parent (its last visited neighbour) when that is still
+ * the parent's own and it has one neighbour more. A clique tree hangs every
+ * other clique off the clique of the parent of its first vertex, their
+ * separator the vertex's visited neighbours.
+ */
+struct analytics {
+    uint64_t               max_clique;
+    uint64_t               chromatic;   /* max_clique, chordal graphs being perfect */
+    uint64_t               independent; /* greedy along the elimination ordering */
+    vertex_t               clique_count;
+
+    /* per clique, the roots of the clique forest their own parent */
+    vertex_t              *clique_parent;
+    vertex_t              *clique_size;
+    vertex_t              *clique_separator;
+    vertex_t              *clique_last; /* it and its visited neighbours are the clique */
+
+    uint8_t               *sector;
+};
+
+/*
+ * The neighbours of `v` for the analytics whichever adjacency there is: its
+ * list, or its bitmask row written out into `scratch`, O(n / 32 + degree).
+ */
+static const vertex_t *
+neighbours(struct context *ctx, vertex_t v, vertex_t *scratch, vertex_t *count)
+{
+    const struct vertex *vertex = &ctx->vertices[v];
+
+    if (ctx->adjacency == ADJ_LIST) {
+        *count = vertex->adj_count;
+        return vertex->adj;
+    }
+
+    *count = 0;
+
+    for (size_t m = 0; m < ctx->mask_len; m++) {
+        for (bitmask_t word = vertex->adj_mask[m]; word != 0; word &= word - 1) {
+            scratch[(*count)++] = m * BITMASK_BITS + __builtin_ctz(word);
+        }
+    }
+
+    return scratch;
+}
+
+/*
+ * After max_clique(), with ctx->order the visit order and every vertex's
+ * pos its place in it. O(n + m), O(n^2 / 32) on bitmask rows.
+ */
+static void
+chordal_analytics(struct context *ctx, struct analytics *analytics)
+{
+    const vertex_t vertex_count = ctx->vertex_count;
+
+    size_t cliques_size = vertex_count * sizeof(vertex_t);
+    size_t marks_size   = vertex_count * sizeof(bool);
+
+    uint8_t *sector = valloc(6 * cliques_size + marks_size);
+    size_t offset = 0;
+
+    analytics->sector = sector;
+
+    analytics->clique_parent = (vertex_t *) &sector[offset];
+    offset += cliques_size;
+
+    analytics->clique_size = (vertex_t *) &sector[offset];
+    offset += cliques_size;
+
+    analytics->clique_separator = (vertex_t *) &sector[offset];
+    offset += cliques_size;
+
+    analytics->clique_last = (vertex_t *) &sector[offset];
+    offset += cliques_size;
+
+    /* the clique of every vertex, and the vertex last added to every clique */
+    vertex_t *clique_of = (vertex_t *) &sector[offset];
+    offset += cliques_size;
+
+    vertex_t *clique_last = analytics->clique_last;
+
+    vertex_t *scratch = (vertex_t *) &sector[offset];
+    offset += cliques_size;
+
+    bool *taken = (bool *) &sector[offset];
+    offset += marks_size;
+
+    analytics->max_clique = 1;
+    analytics->clique_count = 0;
+
+    for (vertex_t pos = 1; pos < vertex_count; pos++) {
+        const vertex_t v = ctx->order[pos];
+        const vertex_t pred_count = ctx->vertices[v].peo_pred_count;
+
+        vertex_t adj_count;
+        const vertex_t *adj = neighbours(ctx, v, scratch, &adj_count);
+
+        /* the last visited neighbour, 0 when there is none */
+        vertex_t parent = 0;
+
+        for (vertex_t a = 0; a < adj_count; a++) {
+            const vertex_t pos_a = ctx->vertices[adj[a]].pos;
+
+            if (pos_a > 0 && pos_a < pos && pos_a > ctx->vertices[parent].pos) {
+                parent = adj[a];
             }
         }
 
-        if (tail_adj != NULL) {
-            tail_adj->set_ends = true;
+        analytics->max_clique = max(analytics->max_clique, pred_count + 1);
+
+        if (parent != 0 && clique_last[clique_of[parent]] == parent
+                && ctx->vertices[parent].peo_pred_count + 1 == pred_count) {
+            clique_of[v] = clique_of[parent];
+            analytics->clique_size[clique_of[v]]++;
+        } else {
+            vertex_t clique = analytics->clique_count++;
+
+            clique_of[v] = clique;
+            analytics->clique_size[clique] = pred_count + 1;
+            analytics->clique_separator[clique] = pred_count;
+            analytics->clique_parent[clique] = parent != 0 ? clique_of[parent] : clique;
         }
-        if (tail_non_adj != NULL) {
-            tail_non_adj->set_ends = true;
+
+        clique_last[clique_of[v]] = v;
+    }
+
+    analytics->chromatic = analytics->max_clique;
+
+    /* a vertex eliminated first has no neighbour taken yet, take it */
+    memset(taken, 0, marks_size);
+    analytics->independent = 0;
+
+    for (vertex_t pos = vertex_count - 1; pos > 0; pos--) {
+        const vertex_t v = ctx->order[pos];
+        bool alone = true;
+
+        vertex_t adj_count;
+        const vertex_t *adj = neighbours(ctx, v, scratch, &adj_count);
+
+        for (vertex_t a = 0; a < adj_count && alone; a++) {
+            alone = !taken[adj[a]];
         }
 
-        
-#if defined(DDEEBBUUGG) && defined(LEX_DEBUG)
-        dprintf("ADJ");
-        print_list(head_adj);
-        dprintf("NON ADJ");
-        print_list(head_non_adj);
-#endif
+        taken[v] = alone;
+        analytics->independent += alone;
+    }
+}
+
+static void
+print_analytics(const struct options *options, const struct analytics *analytics)
+{
+    const char *separator = "";
+
+    if (options->metrics & METRIC_CLIQUE) {
+        printf("%sclique %llu", separator, (unsigned long long) analytics->max_clique);
+        separator = " ";
+    }
+    if (options->metrics & METRIC_CHROMATIC) {
+        printf("%schromatic %llu", separator, (unsigned long long) analytics->chromatic);
+        separator = " ";
+    }
+    if (options->metrics & METRIC_INDEPENDENT) {
+        printf("%sindependent %llu", separator,
+               (unsigned long long) analytics->independent);
+        separator = " ";
+    }
+    if (options->metrics & (METRIC_CLIQUES | METRIC_TREE)) {
+        printf("%scliques %llu", separator,
+               (unsigned long long) analytics->clique_count);
+    }
+    printf("\n");
+
+    /* clique, its parent, its size and the separator to the parent */
+    if (options->metrics & METRIC_TREE) {
+        for (vertex_t c = 0; c < analytics->clique_count; c++) {
+            printf("tree %llu %llu %llu %llu\n", (unsigned long long) c,
+                   (unsigned long long) analytics->clique_parent[c],
+                   (unsigned long long) analytics->clique_size[c],
+                   (unsigned long long) analytics->clique_separator[c]);
+        }
+    }
+}
+
+#include "dynamic.h"
 
-        /* end of set */
+/* a chunk of text below this, or a task of fewer edges, is not worth a thread */
+#define LOAD_MIN_BYTES (1 << 20)
+#define LOAD_MIN_EDGES (1 << 16)
 
-        struct set_node **append_to = &head;
-        if (head != NULL) {
-            append_to = &tail->next;
+/*
+ * With -j above 1 the whole input as the numbers in it, parsed before the
+ * first game. The text is split at line breaks into a chunk per thread, the
+ * chunks count their numbers and then parse them into place after those of
+ * the chunks before. A game takes its numbers off the front, the ends of its
+ * edges straight out of the array.
+ *
+ * With -j 1 nothing is loaded ahead: the numbers taken are read from stdin
+ * there and then into `nums`, grown to the most taken at once, so memory
+ * stays that of the largest game and edits are read as they are solved.
+ */
+struct input {
+    vertex_t              *nums;
+    size_t                 count;
+    size_t                 cursor;
+
+    bool                   stream;
+    size_t                 capacity;
+};
+
+struct load_chunk {
+    const char            *begin;
+    const char            *end;
+
+    size_t                 count;
+    vertex_t              *nums;
+
+} __attribute__ ((aligned (ALIGN_TO)));
+
+/* runs `count` tasks `task_size` apart, the first on the calling thread */
+static void
+fork_join(void *(*run)(void *), void *tasks, size_t task_size, int count)
+{
+    pthread_t *threads = valloc(sizeof(pthread_t) * count);
+    int started = 1;
+
+    for (; started < count; started++) {
+        if (pthread_create(&threads[started], NULL, run,
+                           (uint8_t *) tasks + started * task_size) != 0) {
+            break;
         }
+    }
 
-        if (head_adj != NULL) {
-            *append_to = head_adj;
-            tail_adj->next = head_non_adj;
-        } else {
-            *append_to = head_non_adj;
+    /* those no thread was had for */
+    for (int t = started; t < count; t++) {
+        run((uint8_t *) tasks + t * task_size);
+    }
+
+    run(tasks);
+
+    for (int t = 1; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    free(threads);
+}
+
+static inline bool
+is_digit(char c)
+{
+    return (unsigned) (c - '0') <= 9;
+}
+
+static void *
+count_chunk(void *arg)
+{
+    struct load_chunk *chunk = arg;
+    size_t count = 0;
+    bool digit = false;
+
+    for (const char *at = chunk->begin; at < chunk->end; at++) {
+        count += is_digit(*at) && !digit;
+        digit = is_digit(*at);
+    }
+
+    chunk->count = count;
+    return NULL;
+}
+
+/* anything but a digit separates numbers, as read_num always had it */
+static void *
+parse_chunk(void *arg)
+{
+    struct load_chunk *chunk = arg;
+    const char *at = chunk->begin;
+    const char *end = chunk->end;
+    vertex_t *nums = chunk->nums;
+
+    for (;;) {
+        while (at < end && !is_digit(*at)) {
+            at++;
         }
 
-        if (head_non_adj != NULL) {
-            tail = tail_non_adj;
-        } else if (head_adj != NULL) {
-            tail = tail_adj;
+        if (at == end) {
+            break;
         }
 
+        vertex_t a = 0;
+
+        do {
+            a *= 10;
+            a += *at - '0';
+            at++;
+        } while (at < end && is_digit(*at));
+
+        *nums++ = a;
     }
 
-    *node = head;
+    chunk->count = nums - chunk->nums;
+    return NULL;
+}
 
-#if 0 && defined(DDEEBBUUGG) && defined(LEX_DEBUG)
-    dprintf("AFTER \n");
-    print_list(*node);
-#endif
+/* stdin mapped if it is a file, read to the end otherwise */
+static char *
+read_text(size_t *length, bool *mapped)
+{
+    struct stat st;
+
+    *mapped = false;
+
+    if (fstat(STDIN_FILENO, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, STDIN_FILENO, 0);
+
+        if (mapping != MAP_FAILED) {
+            *length = st.st_size;
+            *mapped = true;
+            return mapping;
+        }
+    }
+
+    size_t capacity = LOAD_MIN_BYTES;
+    char *text = valloc(capacity);
+
+    *length = 0;
+
+    for (;;) {
+        if (*length == capacity) {
+            capacity *= 2;
+            text = realloc(text, capacity);
+        }
+
+        ssize_t got = read(STDIN_FILENO, text + *length, capacity - *length);
+
+        if (got <= 0) {
+            break;
+        }
+
+        *length += got;
+    }
+
+    return text;
 }
 
-uint64_t
-max_clique(struct context *ctx)
+static void
+load_input(struct input *input, int jobs)
 {
-    struct set_node *node = &ctx->set_list[1];
-    uint64_t max_len = ctx->vertices[node->vertex_idx].peo_pred_count + 1;
+    if (jobs == 1) {
+        *input = (struct input) {
+            .stream = true,
+            .capacity = 2,
+            .nums = valloc(sizeof(vertex_t) * 2),
+        };
+        return;
+    }
 
-    lex_bfs_next(ctx, &node);
+    size_t length;
+    bool mapped;
+    char *text = read_text(&length, &mapped);
 
-    while (node != NULL) {
-        max_len = max(max_len, 
-                      ctx->vertices[node->vertex_idx].peo_pred_count + 1);
+    input->stream = false;
+
+    const int chunk_count = max(1, min(jobs, (int64_t) (length / LOAD_MIN_BYTES)));
+
+    input->cursor = 0;
+
+    if (chunk_count == 1) {
+        /* a number and what separates it from the next take two bytes */
+        struct load_chunk chunk = {
+            .begin = text,
+            .end = text + length,
+            .nums = valloc(sizeof(vertex_t) * (length / 2 + 1)),
+        };
 
-        lex_bfs_next(ctx, &node);
+        parse_chunk(&chunk);
+
+        input->nums = chunk.nums;
+        input->count = chunk.count;
+    } else {
+        struct load_chunk *chunks = valloc(sizeof(struct load_chunk) * chunk_count);
+        const char *begin = text;
+
+        for (int c = 0; c < chunk_count; c++) {
+            const char *end = text + length;
+
+            if (c + 1 < chunk_count) {
+                const char *line_break = max(begin, text + length / chunk_count * (c + 1));
+
+                line_break = memchr(line_break, '\n', text + length - line_break);
+                end = line_break != NULL ? line_break + 1 : end;
+            }
+
+            chunks[c] = (struct load_chunk) { .begin = begin, .end = end };
+            begin = end;
+        }
+
+        fork_join(count_chunk, chunks, sizeof(struct load_chunk), chunk_count);
+
+        input->count = 0;
+        for (int c = 0; c < chunk_count; c++) {
+            input->count += chunks[c].count;
+        }
+
+        input->nums = valloc(sizeof(vertex_t) * max(input->count, 1));
+
+        vertex_t *nums = input->nums;
+        for (int c = 0; c < chunk_count; c++) {
+            chunks[c].nums = nums;
+            nums += chunks[c].count;
+        }
+
+        fork_join(parse_chunk, chunks, sizeof(struct load_chunk), chunk_count);
+
+        free(chunks);
     }
 
-    return max_len;
+    if (mapped) {
+        munmap(text, length);
+    } else {
+        free(text);
+    }
+}
+
+static void
+input_ended(void)
+{
+    fprintf(stderr, "unexpected end of input\n");
+    exit(1);
 }
 
-vertex_t
-read_num(void)
+/* the next number on stdin, anything but a digit separating numbers */
+static vertex_t
+stream_num(void)
 {
-    char c;
+    int c;
     vertex_t a = 0;
 
     do {
-        c = getchar();
-    } while(!(c >= '0' && c <= '9'));
+        c = getchar_unlocked();
+    } while (c != EOF && !is_digit(c));
+
+    if (c == EOF) {
+        input_ended();
+    }
 
     do {
         a *= 10;
         a += c - '0';
-        c = getchar();
-    } while(c >= '0' && c <= '9'); 
+        c = getchar_unlocked();
+    } while (c != EOF && is_digit(c));
 
-    /*while (c = getchar(), c != '\n' && c != ' ') {
-        if (c >= '0' && c <= '9') {
-            a *= 10;
-            a += c - '0';
+    return a;
+}
+
+/* the next `count` numbers of the input, streamed ones until the next take */
+static const vertex_t *
+take_nums(struct input *input, size_t count)
+{
+    if (input->stream) {
+        if (count > input->capacity) {
+            input->capacity = max(count, 2 * input->capacity);
+
+            free(input->nums);
+            input->nums = valloc(sizeof(vertex_t) * input->capacity);
         }
-    }*/
 
-    return a;
+        for (size_t i = 0; i < count; i++) {
+            input->nums[i] = stream_num();
+        }
+
+        return input->nums;
+    }
+
+    if (input->count - input->cursor < count) {
+        input_ended();
+    }
+
+    input->cursor += count;
+    return &input->nums[input->cursor - count];
 }
 
-uint64_t
-solve_game(void)
+static vertex_t
+read_num(struct input *input)
+{
+    return *take_nums(input, 1);
+}
+
+/*
+ * The adjacency out of the edges read, split by edges into tasks. Rows are
+ * set by OR, atomic once there are tasks at once. Lists are a counting sort:
+ * every task counts the ends in its edges in a row of its own, the rows
+ * summed per vertex give the lists' places, and every task then fills in its
+ * edges after those of the tasks before it, the lists coming out as they
+ * would on one thread.
+ */
+struct adj_build {
+    struct context        *ctx;
+    const vertex_t        *ends;
+
+    int                    task_count;
+    vertex_t              *counts; /* ADJ_LIST, a row of vertex_count per task */
+};
+
+struct adj_task {
+    struct adj_build      *build;
+    int                    index;
+
+    /* the edges it reads and the vertices whose counts it sums */
+    vertex_t               first_edge;
+    vertex_t               last_edge;
+    vertex_t               first_vertex;
+    vertex_t               last_vertex;
+
+    /* ADJ_LIST, the neighbours of its vertices and then where they start */
+    size_t                 adj_total;
+
+} __attribute__ ((aligned (ALIGN_TO)));
+
+static void *
+mask_edges(void *arg)
+{
+    struct adj_task *task = arg;
+    struct context *ctx = task->build->ctx;
+    const vertex_t *ends = task->build->ends;
+
+    for (vertex_t i = task->first_edge; i < task->last_edge; i++) {
+        struct vertex *a = &ctx->vertices[ends[2 * i]];
+        struct vertex *b = &ctx->vertices[ends[2 * i + 1]];
+
+        BITMASK_SET_ATOMIC(a->adj_mask, ends[2 * i + 1]);
+        BITMASK_SET_ATOMIC(b->adj_mask, ends[2 * i]);
+
+        __atomic_fetch_add(&a->adj_count, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&b->adj_count, 1, __ATOMIC_RELAXED);
+    }
+
+    return NULL;
+}
+
+static void *
+count_edges(void *arg)
+{
+    struct adj_task *task = arg;
+    const struct adj_build *build = task->build;
+    const vertex_t *ends = build->ends;
+    vertex_t *counts = &build->counts[(size_t) task->index * build->ctx->vertex_count];
+
+    memset(counts, 0, sizeof(vertex_t) * build->ctx->vertex_count);
+
+    for (vertex_t i = task->first_edge; i < task->last_edge; i++) {
+        counts[ends[2 * i]]++;
+        counts[ends[2 * i + 1]]++;
+    }
+
+    return NULL;
+}
+
+static void *
+sum_counts(void *arg)
+{
+    struct adj_task *task = arg;
+    const struct adj_build *build = task->build;
+    struct context *ctx = build->ctx;
+    const size_t row = ctx->vertex_count;
+
+    task->adj_total = 0;
+
+    for (vertex_t v = task->first_vertex; v < task->last_vertex; v++) {
+        vertex_t count = 0;
+
+        for (int t = 0; t < build->task_count; t++) {
+            count += build->counts[t * row + v];
+        }
+
+        ctx->vertices[v].adj_count = count;
+        task->adj_total += count;
+    }
+
+    return NULL;
+}
+
+/* the lists of its vertices placed, the counts turned into where each task fills */
+static void *
+place_lists(void *arg)
+{
+    struct adj_task *task = arg;
+    const struct adj_build *build = task->build;
+    struct context *ctx = build->ctx;
+    const size_t row = ctx->vertex_count;
+    vertex_t *adj = &ctx->adj[task->adj_total];
+
+    for (vertex_t v = task->first_vertex; v < task->last_vertex; v++) {
+        vertex_t fill = 0;
+
+        ctx->vertices[v].adj = adj;
+        adj += ctx->vertices[v].adj_count;
+
+        for (int t = 0; t < build->task_count; t++) {
+            const vertex_t count = build->counts[t * row + v];
+
+            build->counts[t * row + v] = fill;
+            fill += count;
+        }
+    }
+
+    return NULL;
+}
+
+static void *
+fill_lists(void *arg)
+{
+    struct adj_task *task = arg;
+    const struct adj_build *build = task->build;
+    struct context *ctx = build->ctx;
+    const vertex_t *ends = build->ends;
+    vertex_t *fill = &build->counts[(size_t) task->index * ctx->vertex_count];
+
+    for (vertex_t i = task->first_edge; i < task->last_edge; i++) {
+        const vertex_t a = ends[2 * i];
+        const vertex_t b = ends[2 * i + 1];
+
+        ctx->vertices[a].adj[fill[a]++] = b;
+        ctx->vertices[b].adj[fill[b]++] = a;
+    }
+
+    return NULL;
+}
+
+/* the neighbour lists back to back, from both ends of every edge read */
+static void
+build_lists(struct context *ctx, const vertex_t *ends)
+{
+    for (vertex_t i = 0; i < ctx->edge_count; i++) {
+        ctx->vertices[ends[2 * i]].adj_count++;
+        ctx->vertices[ends[2 * i + 1]].adj_count++;
+    }
+
+    /* adj_count counted the neighbours, it is the fill cursor meanwhile */
+    vertex_t *adj = ctx->adj;
+    for (vertex_t i = 0; i < ctx->vertex_count; i++) {
+        ctx->vertices[i].adj = adj;
+        adj += ctx->vertices[i].adj_count;
+
+        ctx->vertices[i].adj_count = 0;
+    }
+
+    for (vertex_t i = 0; i < ctx->edge_count; i++) {
+        struct vertex *a = &ctx->vertices[ends[2 * i]];
+        struct vertex *b = &ctx->vertices[ends[2 * i + 1]];
+
+        a->adj[a->adj_count++] = ends[2 * i + 1];
+        b->adj[b->adj_count++] = ends[2 * i];
+    }
+}
+
+static void
+build_masks(struct context *ctx, const vertex_t *ends)
+{
+    for (vertex_t i = 0; i < ctx->edge_count; i++) {
+        struct vertex *a = &ctx->vertices[ends[2 * i]];
+        struct vertex *b = &ctx->vertices[ends[2 * i + 1]];
+
+        BITMASK_SET(a->adj_mask, ends[2 * i + 1]);
+        BITMASK_SET(b->adj_mask, ends[2 * i]);
+
+        a->adj_count++;
+        b->adj_count++;
+    }
+}
+
+/* the adjacency on up to `jobs` threads, on this one alone for few edges */
+static void
+build_adjacency(struct context *ctx, const vertex_t *ends, int jobs)
+{
+    const bool mask = ctx->adjacency == ADJ_MASK;
+    int task_count = max(1, min(jobs, (int64_t) (ctx->edge_count / LOAD_MIN_EDGES)));
+
+    /* no more count rows than the lists take room */
+    if (!mask) {
+        task_count = min(task_count, max(1, 2 * (int64_t) ctx->edge_count / ctx->vertex_count));
+    }
+
+    if (task_count == 1) {
+        if (mask) {
+            build_masks(ctx, ends);
+        } else {
+            build_lists(ctx, ends);
+        }
+        return;
+    }
+
+    struct adj_build build = {
+        .ctx = ctx,
+        .ends = ends,
+        .task_count = task_count,
+        .counts = mask ? NULL : valloc(sizeof(vertex_t) * task_count * ctx->vertex_count),
+    };
+
+    struct adj_task *tasks = valloc(sizeof(struct adj_task) * task_count);
+
+    for (int t = 0; t < task_count; t++) {
+        tasks[t] = (struct adj_task) {
+            .build = &build,
+            .index = t,
+            .first_edge = (uint64_t) ctx->edge_count * t / task_count,
+            .last_edge = (uint64_t) ctx->edge_count * (t + 1) / task_count,
+            .first_vertex = (uint64_t) ctx->vertex_count * t / task_count,
+            .last_vertex = (uint64_t) ctx->vertex_count * (t + 1) / task_count,
+        };
+    }
+
+    if (mask) {
+        fork_join(mask_edges, tasks, sizeof(struct adj_task), task_count);
+    } else {
+        fork_join(count_edges, tasks, sizeof(struct adj_task), task_count);
+        fork_join(sum_counts, tasks, sizeof(struct adj_task), task_count);
+
+        size_t adj_total = 0;
+        for (int t = 0; t < task_count; t++) {
+            const size_t count = tasks[t].adj_total;
+
+            tasks[t].adj_total = adj_total;
+            adj_total += count;
+        }
+
+        fork_join(place_lists, tasks, sizeof(struct adj_task), task_count);
+        fork_join(fill_lists, tasks, sizeof(struct adj_task), task_count);
+    }
+
+    free(build.counts);
+    free(tasks);
+}
+
+/*
+ * --dynamic: a game's edges are followed by a line with the count of
+ * batches of edits, every batch a line with the count of its edits and a
+ * line "<1 to insert, 0 to delete> <a> <b>" per edit. After every batch
+ * "clique <max clique> rejected <edits refused>", an edit refused for
+ * leaving the graph not chordal or for its ends.
+ */
+static void
+solve_edits(struct dynamic *dyn, struct input *input)
+{
+    const vertex_t batch_count = read_num(input);
+
+    for (vertex_t batch = 0; batch < batch_count; batch++) {
+        const vertex_t edit_count = read_num(input);
+        vertex_t rejected = 0;
+
+        for (vertex_t e = 0; e < edit_count; e++) {
+            const vertex_t *edit = take_nums(input, 3);
+            bool done = false;
+
+            if (edit[0] == 1) {
+                done = dynamic_insert(dyn, edit[1], edit[2]);
+            } else if (edit[0] == 0) {
+                done = dynamic_delete(dyn, edit[1], edit[2]);
+            }
+
+            rejected += !done;
+        }
+
+        printf("clique %llu rejected %llu\n", (unsigned long long) dyn->max_clique,
+               (unsigned long long) rejected);
+    }
+}
+
+void
+solve_game(const struct options *options, struct input *input)
 {
     struct context ctx;
 
-    ctx.vertex_count = read_num();
-    ctx.edge_count = read_num();
+    ctx.vertex_count = read_num(input);
+    ctx.edge_count = read_num(input);
     ctx.mask_len = (ctx.vertex_count / BITMASK_BITS) + 1;
+    ctx.mask_len = (ctx.mask_len + LEX_LANES - 1) / LEX_LANES * LEX_LANES;
     ctx.vertex_count++;
 
 /*
@@ -269,86 +1327,244 @@ solve_game(void)
     /* checker counts the instructions sooo */
     /* TODO Improve locality (PC won't be affected?)? */
 
+    ctx.adjacency = choose_mask(ctx.vertex_count, ctx.edge_count, ctx.mask_len)
+        ? ADJ_MASK : ADJ_LIST;
+
+    const bool mask = ctx.adjacency == ADJ_MASK;
+
     size_t vertices_size = ctx.vertex_count                    * sizeof(struct vertex);
-    size_t set_list_size = ctx.vertex_count                    * sizeof(struct set_node);
-    size_t bitmask_size  = (ctx.vertex_count * ctx.mask_len)   * sizeof(bitmask_t);
+    size_t classes_size  = ctx.vertex_count                    * sizeof(struct lex_class);
+    size_t bitmask_size  = mask ? mask_words(ctx.vertex_count, ctx.mask_len)
+                                  * sizeof(bitmask_t) : 0;
+    size_t adj_size      = mask ? 0 : 2 * (size_t) ctx.edge_count * sizeof(vertex_t);
+    size_t order_size    = ctx.vertex_count                    * sizeof(vertex_t);
 
-    uint8_t *big_sector = valloc(vertices_size + set_list_size + bitmask_size);
+    uint8_t *big_sector = valloc(vertices_size + classes_size + bitmask_size
+                                 + adj_size + 4 * order_size);
 
     size_t offset = 0;
 
     ctx.vertices = (struct vertex *) &big_sector[offset];
     offset += vertices_size;
 
-    ctx.set_list = (struct set_node *) &big_sector[offset];
-    offset += set_list_size;
+    ctx.classes = (struct lex_class *) &big_sector[offset];
+    offset += classes_size;
 
     bitmask_t *bitmasks = (bitmask_t *) &big_sector[offset];
     offset += bitmask_size;
 
+    ctx.adj = (vertex_t *) &big_sector[offset];
+    offset += adj_size;
+
+    ctx.order = (vertex_t *) &big_sector[offset];
+    offset += order_size;
+
+    ctx.free_classes = (vertex_t *) &big_sector[offset];
+    offset += order_size;
+
+    ctx.class_size = (vertex_t *) &big_sector[offset];
+    offset += order_size;
+
+    ctx.class_next = (vertex_t *) &big_sector[offset];
+    offset += order_size;
+
+    if (mask) {
+        ctx.class_masks = &bitmasks[ctx.vertex_count * ctx.mask_len];
+        ctx.visited = &ctx.class_masks[ctx.vertex_count * ctx.mask_len];
+
+        memset(ctx.class_masks, 0,
+               (ctx.vertex_count + 1) * ctx.mask_len * sizeof(bitmask_t));
+    }
+
     for (vertex_t i = 0; i < ctx.vertex_count; i++) {
         struct vertex *vertex = &ctx.vertices[i];
 
         vertex->peo_pred_count = 0;
-        vertex->adj_mask = &bitmasks[ctx.mask_len * i];
+        vertex->adj_mask = NULL;
 
-        for (uint64_t m = 0; m < ctx.mask_len; m++) {
-            vertex->adj_mask[m] = 0;
+        if (mask) {
+            vertex->adj_mask = &bitmasks[ctx.mask_len * i];
+
+            for (uint64_t m = 0; m < ctx.mask_len; m++) {
+                vertex->adj_mask[m] = 0;
+            }
         }
 
+        vertex->adj_count = 0;
+        vertex->pos = i;
+        vertex->class_idx = 0;
+        vertex->seen_by = 0;
 
-        struct set_node *node = &ctx.set_list[i];    
-        node->vertex_idx = i;
+        ctx.order[i] = i;
 
-        if (i + 1 < ctx.vertex_count) {
-            node->next = &ctx.set_list[i + 1];
-            node->set_ends = false;
-        } else {
-            node->next = NULL;
-            node->set_ends = true;
-        }
+        /* class 0 holds every vertex but 0, visited from the start */
+        ctx.free_classes[i] = ctx.vertex_count - 1 - i;
     }
 
-    for (vertex_t i = 0; i < ctx.edge_count; i++) {
-        vertex_t a;
-        vertex_t b;
-        /* fscanf(stdin, "%d %d", &a, &b); */
-        a = read_num();
-        b = read_num();
-        
-        BITMASK_SET(ctx.vertices[a].adj_mask, b);
-        BITMASK_SET(ctx.vertices[b].adj_mask, a);
+    ctx.free_class_count = ctx.vertex_count - 1;
+    ctx.classes[0] = (struct lex_class) {
+        .begin = 1,
+        .end = ctx.vertex_count,
+    };
+
+    /* class 1 holds every vertex but 0, class 0 ends the list */
+    if (mask) {
+        bitmask_t *first_class = &ctx.class_masks[ctx.mask_len];
+
+        for (vertex_t i = 1; i < ctx.vertex_count; i++) {
+            BITMASK_SET(first_class, i);
+        }
+
+        ctx.free_class_count = ctx.vertex_count - 2;
+        ctx.class_head = 1;
+        ctx.class_size[1] = ctx.vertex_count - 1;
+        ctx.class_next[1] = 0;
     }
 
+    /* the edges as read, both ends */
+    const vertex_t *ends = take_nums(input, 2 * (size_t) ctx.edge_count);
+
+    build_adjacency(&ctx, ends, options->jobs);
+
     uint64_t solution = max_clique(&ctx) - 1;
     solution = max(solution, 2);
 
+    struct analytics analytics = { 0 };
+
+    if (options->metrics != 0 || options->dynamic) {
+        chordal_analytics(&ctx, &analytics);
+    }
+
+    if (options->metrics != 0) {
+        print_analytics(options, &analytics);
+    } else {
+        printf("%d\n", (int) solution);
+    }
+
+    if (options->dynamic) {
+        struct dynamic dyn;
+
+        dynamic_open(&dyn, &ctx, &analytics);
+        solve_edits(&dyn, input);
+        dynamic_close(&dyn);
+    }
+
+    free(analytics.sector);
+
     free(big_sector);
+}
 
-    return solution;
+
+
+static void
+usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [--metrics clique,chromatic,independent,cliques,tree|all]"
+            " [-j jobs] [--dynamic] < input\n", argv0);
+    exit(2);
 }
 
+static bool
+parse_metrics(unsigned *metrics, char *list)
+{
+    static const struct {
+        const char *name;
+        unsigned metrics;
+    } names[] = {
+        { "clique",      METRIC_CLIQUE      },
+        { "chromatic",   METRIC_CHROMATIC   },
+        { "independent", METRIC_INDEPENDENT },
+        { "cliques",     METRIC_CLIQUES     },
+        { "tree",        METRIC_TREE        },
+        { "all",         METRIC_CLIQUE | METRIC_CHROMATIC | METRIC_INDEPENDENT
+                         | METRIC_CLIQUES | METRIC_TREE },
+    };
+
+    for (char *name = strtok(list, ","); name != NULL; name = strtok(NULL, ",")) {
+        size_t n = 0;
+
+        while (n < sizeof(names) / sizeof(names[0]) && strcmp(names[n].name, name) != 0) {
+            n++;
+        }
+
+        if (n == sizeof(names) / sizeof(names[0])) {
+            return false;
+        }
 
+        *metrics |= names[n].metrics;
+    }
+
+    return true;
+}
+
+static void
+parse_options(struct options *options, int argc, char *argv[])
+{
+    static const struct option long_options[] = {
+        { "metrics", required_argument, NULL, 'm' },
+        { "jobs",    required_argument, NULL, 'j' },
+        { "dynamic", no_argument,       NULL, 'd' },
+        { NULL,      0,                 NULL, 0   },
+    };
+
+    options->metrics = 0;
+    options->jobs = 1;
+    options->dynamic = false;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "m:j:d", long_options, NULL)) != -1) {
+        switch (opt) {
+        case 'm':
+            if (!parse_metrics(&options->metrics, optarg)) {
+                usage(argv[0]);
+            }
+            break;
+
+        /* threads to read and build the adjacency on, 0 for every core */
+        case 'j':
+            options->jobs = atoi(optarg);
+            if (options->jobs <= 0) {
+                options->jobs = sysconf(_SC_NPROCESSORS_ONLN);
+            }
+            break;
+
+        /* batches of edits after every game, see solve_edits() */
+        case 'd':
+            options->dynamic = true;
+            break;
+
+        default:
+            usage(argv[0]);
+        }
+    }
+}
 
 int
-main(int argc, const char *argv[])
+main(int argc, char *argv[])
 {
 #ifdef DDEEBBUUGG
     dot_file = fopen("out.dot", "w");
 #endif
 
+    struct options options;
+    parse_options(&options, argc, argv);
+
+    struct input input;
+    load_input(&input, options.jobs);
+
     int game_count;
     /*fscanf(stdin, "%d", &game_count);*/
 
-    game_count = read_num();
+    game_count = read_num(&input);
 
     /* dprintf("game_count = %d\n", game_count); */
 
     for (int game = 0; game < game_count; game++) {
-        vertex_t solution = solve_game();
-        printf("%d\n", solution);
+        solve_game(&options, &input);
     }
 
+    free(input.nums);
+
 
 #ifdef DDEEBBUUGG
     fclose(dot_file);